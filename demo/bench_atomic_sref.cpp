@@ -0,0 +1,90 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+//
+#include <nnptr/atomic_sref.hpp>
+
+// load throughput of a shared configuration (one writer publishing new
+// versions): nnptr::atomic_sref vs nnptr::sref guarded by std::mutex
+
+struct Config
+{
+   int version;
+   explicit Config(int v)
+     : version{ v }
+   {}
+};
+
+class MutexSref
+{
+public:
+   explicit MutexSref(nnptr::sref<Config> c)
+     : current_{ std::move(c) }
+   {}
+
+   nnptr::sref<Config> load() const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return nnptr::sref<Config>{ current_ };
+   }
+
+   void store(nnptr::sref<Config> desired)
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      std::swap(current_, desired);
+   }
+
+private:
+   mutable std::mutex mutex_;
+   nnptr::sref<Config> current_;
+};
+
+template<class Shared>
+double
+loads_per_second(Shared& shared, int n_readers, int n_loads)
+{
+   std::atomic<bool> done{ false };
+   std::thread writer([&shared, &done]() {
+      int v = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+         shared.store(nnptr::make_sref<Config>(++v));
+         std::this_thread::yield();
+      }
+   });
+   std::vector<std::thread> readers;
+   auto t0 = std::chrono::steady_clock::now();
+   for (int t = 0; t < n_readers; t++)
+      readers.emplace_back([&shared, n_loads]() {
+         long sum = 0;
+         for (int i = 0; i < n_loads; i++)
+            sum += shared.load()->version;
+         if (sum < 0)
+            std::terminate();
+      });
+   for (auto& t : readers)
+      t.join();
+   std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+   done = true;
+   writer.join();
+   return n_readers * (double)n_loads / dt.count();
+}
+
+int
+main()
+{
+   const int n_loads = 1000000;
+   unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+   std::cout << "readers\tmutex+sref (Mloads/s)\tatomic_sref (Mloads/s)" << std::endl;
+   for (unsigned n = 1; n <= max_threads; n *= 2) {
+      MutexSref guarded{ nnptr::make_sref<Config>(0) };
+      nnptr::atomic_sref<Config> atomic{ nnptr::make_sref<Config>(0) };
+      double a = loads_per_second(guarded, n, n_loads);
+      double b = loads_per_second(atomic, n, n_loads);
+      std::cout << n << "\t" << a / 1e6 << "\t\t\t" << b / 1e6 << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+//
+#include <nnptr/sref.hpp>
+
+// copies of a shared default config (each thread copies the same handle):
+// std::shared_ptr vs normal nnptr::sref vs immortal nnptr::sref.
+// normal sref should cost the same as std::shared_ptr (the empty control
+// block branch is already inside std::shared_ptr, sref adds nothing).
+
+struct Config
+{
+   int level{ 3 };
+};
+
+static Config default_config;
+
+// not inlined, so each call really copies (and destroys) the handle
+template<class Handle>
+__attribute__((noinline)) int
+use(Handle h)
+{
+   return h->level;
+}
+
+template<class Handle>
+double
+copies_per_second(const Handle& shared, int n_threads, int n_copies)
+{
+   std::vector<std::thread> threads;
+   auto t0 = std::chrono::steady_clock::now();
+   for (int t = 0; t < n_threads; t++)
+      threads.emplace_back([&shared, n_copies]() {
+         long sum = 0;
+         for (int i = 0; i < n_copies; i++)
+            sum += use<Handle>(shared);
+         if (sum < 0)
+            std::terminate();
+      });
+   for (auto& t : threads)
+      t.join();
+   std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+   return n_threads * (double)n_copies / dt.count();
+}
+
+int
+main()
+{
+   const int n_copies = 10000000;
+   std::shared_ptr<Config> sp = std::make_shared<Config>();
+   nnptr::sref<Config> normal{ sp };
+   nnptr::sref<Config> immortal = nnptr::sref<Config>::immortal(default_config);
+
+   unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+   std::cout << "threads\tshared_ptr (Mcopies/s)\tsref (Mcopies/s)\timmortal sref (Mcopies/s)" << std::endl;
+   for (unsigned n = 1; n <= max_threads; n *= 2) {
+      double a = copies_per_second(sp, n, n_copies);
+      double b = copies_per_second(normal, n, n_copies);
+      double c = copies_per_second(immortal, n, n_copies);
+      std::cout << n << "\t" << a / 1e6 << "\t\t\t" << b / 1e6 << "\t\t\t" << c / 1e6 << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+//
+#include <nnptr/rcu_sref.hpp>
+
+// reader latency (p50/p99/p999) of a lookup table under a writer storm:
+// nnptr::sref swapped under std::mutex vs nnptr::rcu_sref
+
+using Table = std::vector<int>;
+using Clock = std::chrono::steady_clock;
+
+class MutexTable
+{
+public:
+   explicit MutexTable(nnptr::sref<Table> t)
+     : current_{ std::move(t) }
+   {}
+
+   int lookup(int key) const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return current_->at(key);
+   }
+
+   template<class F>
+   void update(F&& fn)
+   {
+      nnptr::sref<Table> next{ nnptr::in_place, *load() };
+      fn(next.get());
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      std::swap(current_, next);
+   }
+
+private:
+   mutable std::mutex mutex_;
+   nnptr::sref<Table> current_;
+
+   nnptr::sref<Table> load() const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return nnptr::sref<Table>{ current_ };
+   }
+};
+
+class RcuTable
+{
+public:
+   explicit RcuTable(nnptr::sref<Table> t)
+     : current_{ std::move(t) }
+   {}
+
+   int lookup(int key) const { return current_.read()->at(key); }
+
+   template<class F>
+   void update(F&& fn)
+   {
+      current_.update(std::forward<F>(fn));
+   }
+
+private:
+   nnptr::rcu_sref<Table> current_;
+};
+
+template<class Shared>
+void
+run(const char* name, int n_readers, int n_lookups)
+{
+   const int table_size = 10000;
+   Shared shared{ nnptr::make_sref<Table>(table_size, 0) };
+   std::atomic<bool> done{ false };
+   std::thread writer([&shared, &done]() {
+      int v = 0;
+      while (!done.load(std::memory_order_relaxed))
+         shared.update([&v](Table& t) { t[v++ % t.size()]++; });
+   });
+   std::vector<std::vector<long>> latencies(n_readers);
+   std::vector<std::thread> readers;
+   for (int t = 0; t < n_readers; t++)
+      readers.emplace_back([&shared, &latencies, t, n_lookups]() {
+         auto& lat = latencies[t];
+         lat.reserve(n_lookups);
+         long sum = 0;
+         for (int i = 0; i < n_lookups; i++) {
+            auto t0 = Clock::now();
+            sum += shared.lookup(i % table_size);
+            lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+         }
+         if (sum < 0)
+            std::terminate();
+      });
+   for (auto& t : readers)
+      t.join();
+   done = true;
+   writer.join();
+
+   std::vector<long> all;
+   for (const auto& lat : latencies)
+      all.insert(all.end(), lat.begin(), lat.end());
+   std::sort(all.begin(), all.end());
+   auto pct = [&all](double p) { return all[static_cast<std::size_t>(p * (all.size() - 1))]; };
+   std::cout << name << "\t" << n_readers << "\t" << pct(0.50) << "\t" << pct(0.99) << "\t" << pct(0.999) << std::endl;
+}
+
+int
+main()
+{
+   const int n_lookups = 200000;
+   unsigned max_threads = std::max(2u, std::thread::hardware_concurrency());
+   std::cout << "kind\t\treaders\tp50(ns)\tp99(ns)\tp999(ns)" << std::endl;
+   for (unsigned n = 1; n < max_threads; n *= 2) {
+      run<MutexTable>("mutex+sref", n, n_lookups);
+      run<RcuTable>("rcu_sref\t", n, n_lookups);
+   }
+   return 0;
+}
@@ -0,0 +1,95 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+//
+#include <nnptr/seqlock_sref.hpp>
+
+// read throughput of a shared best objective value (one writer improving
+// it all the time): nnptr::sref<double> plus std::mutex vs nnptr::seqlock_sref
+
+class MutexBest
+{
+public:
+   MutexBest()
+     : value_{ 1e9 }
+   {}
+
+   double load() const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return *value_;
+   }
+
+   void store(double v)
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      value_ = v;
+   }
+
+private:
+   mutable std::mutex mutex_;
+   nnptr::sref<double> value_;
+};
+
+class SeqlockBest
+{
+public:
+   SeqlockBest()
+     : value_{ 1e9 }
+   {}
+
+   double load() const { return value_.load(); }
+
+   void store(double v) { value_.store(v); }
+
+private:
+   nnptr::seqlock_sref<double> value_;
+};
+
+template<class Shared>
+double
+reads_per_second(int n_readers, int n_reads)
+{
+   Shared best;
+   std::atomic<bool> done{ false };
+   std::thread writer([&best, &done]() {
+      double v = 1e9;
+      while (!done.load(std::memory_order_relaxed)) {
+         best.store(v -= 1.0);
+         std::this_thread::yield();
+      }
+   });
+   std::vector<std::thread> readers;
+   auto t0 = std::chrono::steady_clock::now();
+   for (int t = 0; t < n_readers; t++)
+      readers.emplace_back([&best, n_reads]() {
+         double sum = 0;
+         for (int i = 0; i < n_reads; i++)
+            sum += best.load();
+         if (sum < 0)
+            std::terminate();
+      });
+   for (auto& t : readers)
+      t.join();
+   std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+   done = true;
+   writer.join();
+   return n_readers * (double)n_reads / dt.count();
+}
+
+int
+main()
+{
+   const int n_reads = 5000000;
+   unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+   std::cout << "readers\tmutex+sref (Mreads/s)\tseqlock_sref (Mreads/s)" << std::endl;
+   for (unsigned n = 1; n <= max_threads; n *= 2) {
+      double a = reads_per_second<MutexBest>(n, n_reads);
+      double b = reads_per_second<SeqlockBest>(n, n_reads);
+      std::cout << n << "\t" << a / 1e6 << "\t\t\t" << b / 1e6 << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+//
+#include <nnptr/sharded_sref.hpp>
+
+// copy throughput of a single object referenced by all threads:
+// nnptr::sref (single shared counter) vs nnptr::sharded_sref (per-thread slots)
+
+class Evaluator
+{
+public:
+   int evaluate(int x) const { return x + 1; }
+};
+
+template<class Ref>
+double
+copies_per_second(const Ref& global, int n_threads, int n_copies)
+{
+   std::vector<std::thread> threads;
+   auto t0 = std::chrono::steady_clock::now();
+   for (int t = 0; t < n_threads; t++)
+      threads.emplace_back([&global, n_copies]() {
+         int sum = 0;
+         for (int i = 0; i < n_copies; i++) {
+            Ref local = global; // spawn a task holding the evaluator
+            sum = local->evaluate(sum);
+         }
+         if (sum != n_copies)
+            std::terminate();
+      });
+   for (auto& t : threads)
+      t.join();
+   std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+   return n_threads * (double)n_copies / dt.count();
+}
+
+int
+main()
+{
+   const int n_copies = 2000000;
+   nnptr::sref<Evaluator> plain = nnptr::make_sref<Evaluator>();
+   nnptr::sharded_sref<Evaluator> sharded = nnptr::make_sharded_sref<Evaluator>();
+
+   unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+   std::cout << "threads\tsref (Mcopies/s)\tsharded_sref (Mcopies/s)" << std::endl;
+   for (unsigned n = 1; n <= max_threads; n *= 2) {
+      double a = copies_per_second(plain, n, n_copies);
+      double b = copies_per_second(sharded, n, n_copies);
+      std::cout << n << "\t" << a / 1e6 << "\t\t\t" << b / 1e6 << std::endl;
+   }
+   return 0;
+}
@@ -1,8 +1,18 @@
 
+#include <cassert>
 #include <iostream>
 #include <nnptr/sref.hpp>
+#include <nnptr/sweak.hpp>
 #include <vector>
 
+// number of references to 'ref' while 'value' (taken from it) is in use
+template<class T>
+long
+use_count_during(const T&, const nnptr::sref<T>& ref)
+{
+   return ref.data_.get().use_count();
+}
+
 template<class T>
 using nn_shared_ptr = nnptr::NotNull<std::shared_ptr<T>>;
 
@@ -38,6 +48,20 @@ private:
    std::vector<nnptr::sref<Person>> employees; // shared ownership!
 };
 
+class Company3;
+
+class Person3
+{
+public:
+   nnptr::sweak<Company3> company; // observer only (no cycle)
+};
+
+class Company3
+{
+public:
+   std::vector<nnptr::sref<Person3>> employees; // shared ownership!
+};
+
 int
 main()
 {
@@ -59,6 +83,20 @@ main()
    // automatic conversion to internal type int
    std::cout << p3 << std::endl;
 
+   // ==========================================
+   // access does not copy the shared_ptr (no reference counting)
+   //
+   static_assert(std::is_reference<decltype(p1.data_.get())>::value,
+                 "NotNull<shared_ptr> must be accessed by reference");
+   // temporaries live until the end of each full expression, so a hidden
+   // shared_ptr copy would still be counted inside these checks
+   assert(use_count_during(*p1, p1) == 2);
+   assert(use_count_during(p3.get(), p1) == 2);
+   assert(use_count_during(*p1.data_, p1) == 2);
+   std::hash<nnptr::NotNull<std::shared_ptr<int>>>{}(p1.data_);
+   assert(p1.data_ == p3.data_);
+   assert(p1.data_.get().use_count() == 2);
+
    // automatic conversion to internal type int
    auto p4 = p1 + p3;
    std::cout << typeid(p4).name() << ": " << p4 << std::endl;
@@ -117,5 +155,15 @@ main()
    nnptr::sref<B> b2 = b;
    nnptr::sref<A> a = b;
 
+   // ==========================================
+   // weak references break cycles
+   //
+   nnptr::sref<Company3> company{ new Company3 };
+   nnptr::sref<Person3> employee{ new Person3 };
+   employee->company = company;
+   company->employees.push_back(employee);
+   if (auto c = employee->company.lock())
+      std::cout << "employees: " << c->employees.size() << std::endl;
+
    return 0;
 }
\ No newline at end of file
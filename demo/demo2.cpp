@@ -1,6 +1,8 @@
 
+#include <cassert>
 #include <iostream>
 #include <memory>
+#include <vector>
 //
 #include <nnptr/sref.hpp>
 
@@ -17,9 +19,33 @@ checkValues(Lhs lhs, Rhs rhs)
 class TestClass
 {};
 
+class BaseTestClass
+{
+public:
+   virtual ~BaseTestClass() = default;
+};
+
+class DerivedTestClass : public BaseTestClass
+{};
+
+// vectors of NotNull will move (not copy) elements when growing
+static_assert(std::is_nothrow_move_constructible<nnptr::NotNull<std::shared_ptr<int>>>::value,
+              "NotNull<shared_ptr> should be nothrow movable");
+
 int
 main()
 {
+   // ========= MOVE TEST ==========
+   // runs first, since next tests break on Debug (on purpose)
+   // NotNull<unique_ptr> can be moved (moved-from object can only be destroyed or assigned to)
+   nnptr::NotNull<std::unique_ptr<DerivedTestClass>> unique_a{ std::make_unique<DerivedTestClass>() };
+   nnptr::NotNull<std::unique_ptr<BaseTestClass>> unique_b{ std::move(unique_a) };
+   std::vector<nnptr::NotNull<std::unique_ptr<BaseTestClass>>> v_unique;
+   v_unique.push_back(std::move(unique_b));
+   v_unique.push_back(std::make_unique<DerivedTestClass>());
+   assert(v_unique.size() == 2);
+   std::cout << v_unique.size() << std::endl;
+
    // ========= FIRST TEST ==========
    int* myptr = nullptr;
    // next line breaks on Debug only (without -DNDEBUG)
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <nnptr/intrusive_sref.hpp>
+#include <nnptr/local_sref.hpp>
+#include <nnptr/sharded_sref.hpp>
+#include <nnptr/sref.hpp>
+#include <nnptr/thin_sref.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// standard algorithms assign to moved-from elements: a moved-from handle
+// takes the other object, while a live handle writes through
+
+struct Num : public nnptr::intrusive_counter<Num>
+{
+   int n;
+   std::string text; // empty when moved from
+
+   Num(int _n)
+     : n{ _n }
+     , text{ std::to_string(_n) }
+   {}
+};
+
+template<class T>
+long
+count_of(const nnptr::sref<T>& s)
+{
+   return s.data_.get().use_count();
+}
+
+template<class Handle>
+long
+count_of(const Handle& h)
+{
+   return h.use_count();
+}
+
+template<class Handle>
+std::vector<int>
+values(const std::vector<Handle>& v)
+{
+   std::vector<int> out;
+   for (const auto& h : v)
+      out.push_back(h->n);
+   return out;
+}
+
+template<class Handle, class Make>
+void
+check_algorithms(const char* name, Make make)
+{
+   std::vector<Handle> v;
+   v.reserve(8); // no reallocation: insert moves and assigns elements
+   for (int i = 0; i < 3; i++)
+      v.push_back(make(i));
+
+   v.insert(v.begin(), make(9));
+   assert((values(v) == std::vector<int>{ 9, 0, 1, 2 }));
+
+   // elements shared outside the vector are never moved from
+   Handle keep = v.back();
+   v.erase(v.begin() + 1);
+   assert((values(v) == std::vector<int>{ 9, 1, 2 }));
+   assert(keep->n == 2 && keep->text == "2");
+
+   // swap exchanges handles (each one keeps a single owner)
+   Handle a = make(1);
+   Handle b = make(2);
+   const Num* pa = &a.get();
+   (void)pa;
+   std::swap(a, b);
+   assert(a->n == 2 && b->n == 1 && &b.get() == pa);
+   assert(count_of(a) == 1 && count_of(b) == 1);
+
+   std::rotate(v.begin(), v.begin() + 1, v.end());
+   assert((values(v) == std::vector<int>{ 1, 2, 9 }));
+
+   std::reverse(v.begin(), v.end());
+   assert((values(v) == std::vector<int>{ 9, 2, 1 }));
+
+   // assignment to a moved-from handle rebinds it (copy shares the object)
+   Handle c = make(5);
+   Handle d{ std::move(c) };
+   c = d;
+   assert(&c.get() == &d.get() && count_of(d) == 2);
+
+   std::cout << name << ": ";
+   for (int x : values(v))
+      std::cout << x << " ";
+   std::cout << std::endl;
+}
+
+int
+main()
+{
+   check_algorithms<nnptr::sref<Num>>("sref", [](int n) { return nnptr::make_sref<Num>(n); });
+   check_algorithms<nnptr::local_sref<Num>>("local_sref", [](int n) { return nnptr::make_local_sref<Num>(n); });
+   check_algorithms<nnptr::intrusive_sref<Num>>("intrusive_sref", [](int n) { return nnptr::make_intrusive_sref<Num>(n); });
+   check_algorithms<nnptr::thin_sref<Num>>("thin_sref", [](int n) { return nnptr::make_thin_sref<Num>(n); });
+   check_algorithms<nnptr::sharded_sref<Num>>("sharded_sref", [](int n) { return nnptr::make_sharded_sref<Num>(n); });
+   return 0;
+}
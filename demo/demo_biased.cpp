@@ -0,0 +1,49 @@
+#include <cassert>
+#include <iostream>
+#include <nnptr/biased_sref.hpp>
+#include <stdexcept>
+#include <thread>
+
+// biased_sref: owner thread counts without atomics, other threads share
+// an atomic counter (constructors that throw leave no trace behind)
+
+struct Fails
+{
+   explicit Fails(bool fail)
+   {
+      if (fail)
+         throw std::runtime_error("construction failed");
+   }
+};
+
+int
+main()
+{
+   nnptr::biased_sref<int> a = nnptr::make_biased_sref<int>(1);
+
+   bool thrown = false;
+   try {
+      nnptr::biased_sref<Fails> f = nnptr::make_biased_sref<Fails>(true);
+   } catch (const std::runtime_error&) {
+      thrown = true;
+   }
+   assert(thrown);
+   (void)thrown;
+
+   // owner list is still consistent after the failed construction
+   for (int i = 0; i < 100; i++) {
+      nnptr::biased_sref<int> b = nnptr::make_biased_sref<int>(i);
+      nnptr::biased_sref<Fails> ok = nnptr::make_biased_sref<Fails>(false);
+      assert(*b == i);
+   }
+
+   // references dying on another thread are merged back by owner
+   nnptr::biased_sref<int> c = nnptr::make_biased_sref<int>(2);
+   std::thread t([copy = c]() { assert(*copy == 2); });
+   t.join();
+   nnptr::biased_collect();
+   assert(*a == 1 && *c == 2);
+
+   std::cout << "biased_sref: ok" << std::endl;
+   return 0;
+}
@@ -0,0 +1,130 @@
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <nnptr/sref_channel.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// sref channels: handles are moved through a bounded ring (never copied),
+// in order, between producer and consumer threads
+
+// output iterator that pushes back into the channel it pops from (a slot
+// must already be free when the popped handle is written)
+template<class Channel>
+struct refill_iterator
+{
+   Channel* channel;
+   int* pushed;
+
+   refill_iterator& operator*() { return *this; }
+   refill_iterator& operator++() { return *this; }
+   refill_iterator operator++(int) { return *this; }
+
+   refill_iterator& operator=(nnptr::sref<int>&& ref)
+   {
+      bool ok = channel->try_push(nnptr::make_sref<int>(*ref + 100));
+      assert(ok);
+      (void)ok;
+      (*pushed)++;
+      return *this;
+   }
+};
+
+template<class Channel>
+void
+check_full_empty(Channel& ch)
+{
+   assert(ch.capacity() == 4);
+   std::vector<nnptr::sref<int>> out;
+   assert(!ch.try_pop(std::back_inserter(out)));
+   for (int i = 0; i < 4; i++)
+      assert(ch.try_push(nnptr::make_sref<int>(i)));
+   // full: argument is kept
+   nnptr::sref<int> extra = nnptr::make_sref<int>(4);
+   assert(!ch.try_push(std::move(extra)));
+   assert(*extra == 4 && extra.data_.get().use_count() == 1);
+
+   // batch pop takes at most 'max', in order
+   assert(ch.try_pop_batch(std::back_inserter(out), 3) == 3);
+   assert(out.size() == 3 && *out[0] == 0 && *out[1] == 1 && *out[2] == 2);
+   assert(ch.try_pop_batch(std::back_inserter(out), 8) == 1 && *out[3] == 3);
+   assert(ch.try_pop_batch(std::back_inserter(out), 8) == 0);
+
+   // every slot is released before the popped handle is written
+   for (int i = 0; i < 4; i++)
+      ch.push(nnptr::make_sref<int>(i));
+   int pushed = 0;
+   assert(ch.try_pop_batch(refill_iterator<Channel>{ &ch, &pushed }, 4) == 4);
+   assert(pushed == 4);
+   out.clear();
+   assert(ch.try_pop_batch(std::back_inserter(out), 8) == 4);
+   assert(*out[0] == 100 && *out[3] == 103);
+}
+
+int
+main()
+{
+   // capacity is rounded up to a power of two
+   nnptr::spsc_channel<int> spsc_small{ 3 };
+   check_full_empty(spsc_small);
+   nnptr::mpmc_channel<int> mpmc_small{ 3 };
+   check_full_empty(mpmc_small);
+
+   const int n = 100000;
+
+   // spsc: consumer sees producer order (handles arrive unshared)
+   nnptr::spsc_channel<int> spsc{ 64 };
+   std::thread producer{ [&spsc]() {
+      for (int i = 0; i < n; i++)
+         spsc.push(nnptr::make_sref<int>(i));
+   } };
+   int expected = 0;
+   std::vector<nnptr::sref<int>> batch;
+   while (expected < n) {
+      batch.clear();
+      spsc.pop_batch(std::back_inserter(batch), 16);
+      for (auto& ref : batch) {
+         assert(*ref == expected && ref.data_.get().use_count() == 1);
+         expected++;
+      }
+   }
+   producer.join();
+
+   // mpmc: every handle arrives once, and each consumer sees the handles of
+   // each producer in order
+   const int producers = 4;
+   const int consumers = 4;
+   nnptr::mpmc_channel<std::pair<int, int>> mpmc{ 64 };
+   std::vector<std::thread> threads;
+   for (int p = 0; p < producers; p++)
+      threads.emplace_back([&mpmc, p]() {
+         for (int i = 0; i < n; i++)
+            mpmc.push(nnptr::make_sref<std::pair<int, int>>(p, i));
+      });
+   std::vector<std::vector<int>> seen(consumers, std::vector<int>(producers, 0));
+   for (int c = 0; c < consumers; c++)
+      threads.emplace_back([&mpmc, &seen, c]() {
+         std::vector<int> last(producers, -1);
+         for (int k = 0; k < n; k++) {
+            nnptr::sref<std::pair<int, int>> ref = mpmc.pop();
+            assert(ref->second > last[ref->first]);
+            last[ref->first] = ref->second;
+            seen[c][ref->first]++;
+         }
+      });
+   for (auto& t : threads)
+      t.join();
+   for (int p = 0; p < producers; p++) {
+      int total = 0;
+      for (int c = 0; c < consumers; c++)
+         total += seen[c][p];
+      assert(total == n);
+      (void)total;
+   }
+   std::vector<nnptr::sref<std::pair<int, int>>> rest;
+   assert(mpmc.try_pop_batch(std::back_inserter(rest), 8) == 0);
+
+   std::cout << "sref_channel: ok" << std::endl;
+   return 0;
+}
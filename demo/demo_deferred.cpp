@@ -0,0 +1,95 @@
+#include <cassert>
+#include <iostream>
+#include <nnptr/deferred_sref.hpp>
+#include <thread>
+
+// deferred_sref: releases are logged per thread (a new copy cancels a
+// logged release) and objects only die on flush() or end of deferred_scope
+
+struct Tracked
+{
+   static int destroyed;
+   int n;
+
+   explicit Tracked(int _n)
+     : n{ _n }
+   {}
+
+   ~Tracked() { destroyed++; }
+};
+
+int Tracked::destroyed = 0;
+
+// shared counter, as seen by a thread with no pending releases
+long
+shared_count(const nnptr::deferred_sref<Tracked>& ref)
+{
+   long count = 0;
+   std::thread t([&ref, &count]() { count = ref.use_count(); });
+   t.join();
+   return count;
+}
+
+int
+main()
+{
+   nnptr::deferred_sref<Tracked> a = nnptr::make_deferred_sref<Tracked>(1);
+   assert(a.use_count() == 1 && shared_count(a) == 1);
+
+   // release is logged (shared counter unchanged), and then cancelled by
+   // the next copy on this thread (shared counter is never touched again)
+   {
+      nnptr::deferred_sref<Tracked> b = a;
+      assert(shared_count(a) == 2);
+   }
+   assert(a.use_count() == 1 && shared_count(a) == 2);
+   for (int i = 0; i < 100; i++) {
+      nnptr::deferred_sref<Tracked> c = a;
+      assert(c.use_count() == 2);
+   }
+   assert(a.use_count() == 1 && shared_count(a) == 2);
+   nnptr::flush();
+   assert(a.use_count() == 1 && shared_count(a) == 1);
+
+   // last release only destroys the object on flush()
+   {
+      nnptr::deferred_sref<Tracked> d = nnptr::make_deferred_sref<Tracked>(2);
+   }
+   assert(Tracked::destroyed == 0);
+   nnptr::flush();
+   assert(Tracked::destroyed == 1);
+
+   // ... or at the end of a deferred_scope
+   {
+      nnptr::deferred_scope scope;
+      for (int i = 0; i < 10; i++) {
+         nnptr::deferred_sref<Tracked> e = nnptr::make_deferred_sref<Tracked>(i);
+         assert(e->n == i);
+      }
+      assert(Tracked::destroyed == 1);
+   }
+   assert(Tracked::destroyed == 11);
+
+   // last reference released on another thread (applied at its exit)
+   {
+      nnptr::deferred_sref<Tracked> f = nnptr::make_deferred_sref<Tracked>(3);
+      std::thread t([g = std::move(f)]() { assert(g->n == 3); });
+      t.join();
+   }
+   assert(Tracked::destroyed == 12);
+
+   // release pending on this thread keeps object alive until its flush
+   {
+      nnptr::deferred_sref<Tracked> h = nnptr::make_deferred_sref<Tracked>(4);
+      std::thread t([copy = h]() { assert(copy->n == 4); });
+      t.join();
+      assert(h.use_count() == 1);
+   }
+   assert(Tracked::destroyed == 12);
+   nnptr::flush();
+   assert(Tracked::destroyed == 13);
+
+   assert(a->n == 1);
+   std::cout << "deferred_sref: ok" << std::endl;
+   return 0;
+}
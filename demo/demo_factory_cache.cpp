@@ -0,0 +1,71 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <nnptr/sref_factory_cache.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+// sref_factory_cache: while a value is alive, its key gives the same sref
+// (built once, even under concurrent lookups); dead values are rebuilt
+
+int
+main()
+{
+   nnptr::sref_factory_cache<int, std::string> cache;
+   int built = 0;
+   auto build = [&built]() {
+      built++;
+      return nnptr::make_sref<const std::string>("value");
+   };
+
+   // same object while some sref keeps it alive
+   {
+      nnptr::sref<const std::string> a = cache.get(1, build);
+      nnptr::sref<const std::string> b = cache.get(1, build);
+      assert(&a.get() == &b.get() && *a == "value");
+      assert(built == 1 && cache.stats().hits == 1 && cache.stats().builds == 1);
+   }
+
+   // all users dropped it: next lookup builds it again
+   nnptr::sref<const std::string> c = cache.get(1, build);
+   assert(built == 2 && cache.stats().builds == 2);
+   cache.prune();
+   assert(cache.stats().entries == 1);
+
+   // concurrent lookups of the same key: factory runs exactly once
+   const int n_threads = 8;
+   std::atomic<int> slow_builds{ 0 };
+   std::atomic<bool> start{ false };
+   std::atomic<int> arrived{ 0 };
+   std::vector<const std::string*> seen(n_threads, nullptr);
+   std::vector<std::thread> threads;
+   for (int t = 0; t < n_threads; t++)
+      threads.emplace_back([&, t]() {
+         while (!start)
+            std::this_thread::yield();
+         nnptr::sref<const std::string> v = cache.get(2, [&slow_builds]() {
+            slow_builds++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return nnptr::make_sref<const std::string>("slow");
+         });
+         seen[t] = &v.get();
+         // value stays alive until every thread got it
+         arrived++;
+         while (arrived < n_threads)
+            std::this_thread::yield();
+      });
+   start = true;
+   for (auto& t : threads)
+      t.join();
+   assert(slow_builds == 1);
+   for (int t = 0; t < n_threads; t++)
+      assert(seen[t] == seen[0]);
+   nnptr::sref_factory_cache_stats s = cache.stats();
+   assert(s.builds == 3 && s.hits + s.waits == 1 + (n_threads - 1));
+   (void)s;
+
+   std::cout << "sref_factory_cache: ok" << std::endl;
+   return 0;
+}
@@ -0,0 +1,36 @@
+#include <cassert>
+#include <iostream>
+#include <nnptr/lru_cache.hpp>
+#include <string>
+
+// lru_cache: capacity is split among shards, so small caches use fewer
+// shards and entries larger than one shard are reported (never cached)
+
+int
+main()
+{
+   // capacity smaller than number of shards: total is still respected
+   nnptr::lru_cache<int, std::string> small{ 4, 16 };
+   assert(small.shard_count() == 1 && small.max_entry_size() == 4);
+   for (int i = 0; i < 10; i++)
+      small.put(i, nnptr::make_sref<const std::string>(std::to_string(i)));
+   assert(small.stats().entries == 4 && small.stats().size == 4);
+
+   // exact split: sum of shard capacities is the total capacity
+   nnptr::lru_cache<int, std::string> odd{ 1000, 16 };
+   for (int i = 0; i < 5000; i++)
+      odd.put(i, nnptr::make_sref<const std::string>("x"));
+   assert(odd.stats().size <= 1000);
+
+   // entries larger than one shard are rejected (and counted)
+   nnptr::lru_cache<int, std::string> big{ 1024, 16 };
+   assert(big.shard_count() == 16 && big.max_entry_size() == 64);
+   assert(!big.put(1, nnptr::make_sref<const std::string>("large"), 100));
+   assert(big.put(2, nnptr::make_sref<const std::string>("fits"), 64));
+   assert(big.stats().rejections == 1 && big.stats().entries == 1);
+   auto loaded = big.get_or_load(3, []() { return nnptr::make_sref<const std::string>("large"); }, 200);
+   assert(*loaded == "large" && big.stats().rejections == 2);
+
+   std::cout << "lru_cache: ok" << std::endl;
+   return 0;
+}
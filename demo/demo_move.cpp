@@ -0,0 +1,116 @@
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <nnptr/sref.hpp>
+#include <nnptr/uref.hpp>
+#include <vector>
+
+// counts every copy and move of the shared object
+class Counted
+{
+public:
+   static int copies;
+   static int moves;
+
+   std::vector<int> v;
+
+   explicit Counted(int n)
+     : v(n, 1)
+   {}
+
+   Counted(const Counted& other)
+     : v{ other.v }
+   {
+      copies++;
+   }
+
+   Counted(Counted&& other) noexcept
+     : v{ std::move(other.v) }
+   {
+      moves++;
+   }
+
+   Counted& operator=(const Counted& other)
+   {
+      v = other.v;
+      copies++;
+      return *this;
+   }
+
+   Counted& operator=(Counted&& other) noexcept
+   {
+      v = std::move(other.v);
+      moves++;
+      return *this;
+   }
+};
+
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+int
+main()
+{
+   // rvalue is moved into the new shared object (no copy)
+   nnptr::sref<Counted> s1{ Counted(5) };
+   assert(Counted::copies == 0 && Counted::moves == 1);
+   assert(s1.data_.get().use_count() == 1);
+
+   // ownership is transferred (no copy, no reference counting)
+   nnptr::sref<Counted> s2{ std::move(s1) };
+   assert(Counted::copies == 0 && Counted::moves == 1);
+   assert(s2.data_.get().use_count() == 1);
+
+   std::shared_ptr<Counted> sp = std::make_shared<Counted>(5);
+   nnptr::sref<Counted> s3{ std::move(sp) };
+   assert(!sp && s3.data_.get().use_count() == 1);
+
+   std::unique_ptr<Counted> up{ new Counted(5) };
+   nnptr::sref<Counted> s4{ std::move(up) };
+   assert(!up && s4.data_.get().use_count() == 1);
+   assert(Counted::copies == 0 && Counted::moves == 1);
+
+   // assignment writes through (moving the value)
+   s4 = Counted(3);
+   assert(Counted::copies == 0 && Counted::moves == 2);
+   assert(s4->v.size() == 3 && s4.data_.get().use_count() == 1);
+
+   // vector growth moves handles (no reference counting, no object copy)
+   static_assert(std::is_nothrow_move_constructible<nnptr::sref<Counted>>::value,
+                 "vector growth must move sref (not copy it)");
+   std::vector<nnptr::sref<Counted>> vs;
+   for (int i = 0; i < 10; i++) {
+      nnptr::sref<Counted> s{ nnptr::in_place, i + 1 };
+      vs.push_back(std::move(s));
+   }
+   for (int i = 0; i < 10; i++) {
+      assert(vs[i]->v.size() == static_cast<std::size_t>(i + 1));
+      assert(vs[i].data_.get().use_count() == 1);
+   }
+   assert(Counted::copies == 0 && Counted::moves == 2);
+
+   // single owner (no counting) published later as sref (no copy, no allocation)
+   nnptr::uref<Counted> u = nnptr::make_uref<Counted>(5);
+   nnptr::uref<Counted> u2{ std::move(u) };
+   nnptr::sref<Counted> s5 = std::move(u2).share();
+   assert(Counted::copies == 0 && Counted::moves == 2);
+   assert(s5.data_.get().use_count() == 1);
+
+   // move assignment hands over the object (swap, vector erase never touch it)
+   std::vector<nnptr::uref<Counted>> us;
+   for (int i = 0; i < 4; i++)
+      us.push_back(nnptr::make_uref<Counted>(i + 1));
+   us.erase(us.begin());
+   std::swap(us[0], us[2]);
+   assert(us.size() == 3 && us[0]->v.size() == 4 && us[1]->v.size() == 3 && us[2]->v.size() == 2);
+   nnptr::uref<Counted> u3 = nnptr::make_uref<Counted>(7);
+   u3 = std::move(us[0]);
+   assert(u3->v.size() == 4);
+   assert(Counted::copies == 0 && Counted::moves == 2);
+
+   std::cout << "copies=" << Counted::copies << " moves=" << Counted::moves << std::endl;
+   return 0;
+}
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <nnptr/rcu_sref.hpp>
+#include <thread>
+#include <vector>
+
+// rcu_sref: readers take snapshots of a table that writers replace, and
+// superseded versions are freed as soon as no snapshot can see them
+
+struct Table
+{
+   static std::atomic<int> alive;
+
+   std::vector<int> rows;
+
+   explicit Table(int n)
+     : rows(n, n)
+   {
+      alive++;
+   }
+
+   Table(const Table& other)
+     : rows{ other.rows }
+   {
+      alive++;
+   }
+
+   ~Table() { alive--; }
+};
+
+std::atomic<int> Table::alive{ 0 };
+
+int
+main()
+{
+   nnptr::epoch_domain domain;
+   {
+      nnptr::rcu_sref<Table> table{ nnptr::make_sref<Table>(10), domain };
+
+      // without readers, old versions are freed by the writer right away
+      for (int i = 0; i < 100; i++) {
+         table.update([](Table& t) { t.rows.push_back(1); });
+         assert(Table::alive == 1);
+         assert(domain.pending() == 0);
+      }
+      assert(table.read()->rows.size() == 110);
+
+      // a snapshot keeps its version (and later ones wait for the next update)
+      {
+         auto snap = table.read();
+         table.store(nnptr::make_sref<Table>(5));
+         assert(snap->rows.size() == 110);
+         assert(Table::alive == 2);
+      }
+      table.store(nnptr::make_sref<Table>(6));
+      assert(Table::alive == 1 && domain.pending() == 0);
+
+      // readers on other threads while writer keeps publishing
+      std::atomic<bool> done{ false };
+      std::vector<std::thread> readers;
+      for (int t = 0; t < 2; t++)
+         readers.emplace_back([&table, &done]() {
+            while (!done) {
+               auto snap = table.read();
+               assert(snap->rows.size() == static_cast<std::size_t>(snap->rows[0]));
+            }
+         });
+      for (int i = 1; i < 1000; i++)
+         table.store(nnptr::make_sref<Table>(i % 50 + 1));
+      done = true;
+      for (auto& r : readers)
+         r.join();
+      table.synchronize();
+      assert(Table::alive == 1 && domain.pending() == 0);
+   }
+   assert(Table::alive == 0);
+   std::cout << "rcu_sref: ok" << std::endl;
+   return 0;
+}
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <nnptr/reclaim_domain.hpp>
+#include <thread>
+#include <vector>
+
+// reclaim_domain: last release only enqueues the object, its destructor
+// runs on the pool (and a full queue blocks, or destroys inline)
+
+struct Node
+{
+   static std::atomic<int> destroyed;
+   static std::atomic<int> on_caller; // destroyed by main thread
+   static std::thread::id caller;
+
+   ~Node()
+   {
+      destroyed++;
+      if (std::this_thread::get_id() == caller)
+         on_caller++;
+   }
+};
+
+std::atomic<int> Node::destroyed{ 0 };
+std::atomic<int> Node::on_caller{ 0 };
+std::thread::id Node::caller = std::this_thread::get_id();
+
+// keeps the pool busy (destructor waits until it is opened)
+struct Gate
+{
+   static std::atomic<bool> entered;
+   static std::atomic<bool> open;
+
+   ~Gate()
+   {
+      entered = true;
+      while (!open)
+         std::this_thread::yield();
+   }
+
+   static void reset()
+   {
+      entered = false;
+      open = false;
+   }
+};
+
+std::atomic<bool> Gate::entered{ false };
+std::atomic<bool> Gate::open{ false };
+
+int
+main()
+{
+   // objects die on the pool, and drain() waits for all of them
+   {
+      nnptr::reclaim_domain domain{ 2 };
+      std::vector<nnptr::sref<Node>> nodes;
+      for (int i = 0; i < 100; i++)
+         nodes.push_back(domain.make_sref<Node>());
+      nodes.clear();
+      domain.retire(new Node{});
+      domain.drain();
+      nnptr::reclaim_stats s = domain.stats();
+      assert(s.enqueued == 101 && s.destroyed == 101 && s.pending == 0);
+      assert(s.inlined == 0 && s.blocked == 0);
+      assert(Node::destroyed == 101 && Node::on_caller == 0);
+      (void)s;
+   }
+
+   // backpressure: a full queue blocks the releasing thread until there is room
+   {
+      Gate::reset();
+      nnptr::reclaim_domain domain{ 1, 2 };
+      domain.retire(new Gate{});
+      while (!Gate::entered)
+         std::this_thread::yield();
+      domain.retire(new Node{});
+      domain.retire(new Node{});
+      assert(domain.stats().pending == 2);
+      std::atomic<bool> done{ false };
+      std::thread releaser([&domain, &done]() {
+         domain.retire(new Node{});
+         done = true;
+      });
+      while (domain.stats().blocked == 0)
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      assert(!done && domain.stats().pending == 2);
+      Gate::open = true;
+      releaser.join();
+      domain.drain();
+      nnptr::reclaim_stats s = domain.stats();
+      assert(s.enqueued == 4 && s.destroyed == 4 && s.blocked == 1);
+      assert(s.max_pending == 2 && s.pending == 0 && s.inlined == 0);
+      assert(Node::destroyed == 104 && Node::on_caller == 0);
+      (void)s;
+   }
+
+   // run_inline: a full queue makes the releasing thread destroy it
+   {
+      Gate::reset();
+      nnptr::reclaim_domain domain{ 1, 1, nnptr::reclaim_overflow::run_inline };
+      domain.retire(new Gate{});
+      while (!Gate::entered)
+         std::this_thread::yield();
+      domain.retire(new Node{});
+      {
+         nnptr::sref<Node> last = domain.make_sref<Node>();
+      }
+      assert(Node::on_caller == 1 && domain.stats().inlined == 1);
+      Gate::open = true;
+      domain.drain();
+      nnptr::reclaim_stats s = domain.stats();
+      assert(s.enqueued == 2 && s.destroyed == 2 && s.blocked == 0);
+      assert(Node::destroyed == 106);
+      (void)s;
+   }
+
+   std::cout << "reclaim_domain: ok" << std::endl;
+   return 0;
+}
@@ -1,5 +1,6 @@
 
 #include <iostream>
+#include <nnptr/boxed.hpp>
 #include <nnptr/sref.hpp>
 #include <vector>
 
@@ -12,6 +13,13 @@ foo(sref<int> si)
    return new double{ d };
 }
 
+// common small values are shared (no allocation, no reference counting)
+sref<const int>
+twice(sref<const int> si)
+{
+   return nnptr::box(2 * *si);
+}
+
 int
 main()
 {
@@ -20,6 +28,9 @@ main()
    sd++;
    std::cout << *sd << std::endl;
 
+   sref<const int> s20 = twice(nnptr::box(10));
+   std::cout << "twice(10) = " << *s20 << std::endl;
+
    sref<std::vector<int>> nnsptr_3{ std::vector<int>(5, 1) };
    // getting the first element in vector
    std::cout << "v[0] = " << nnsptr_3->at(0) << std::endl;
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <nnptr/synchronized_sref.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// synchronized_sref: shared ownership together with a lock, so writes
+// through any sharer never race with reads from other threads
+
+int
+main()
+{
+   auto counter = nnptr::make_synchronized_sref<std::vector<int>>();
+
+   // writers on several threads (each one through its own copy)
+   std::vector<std::thread> threads;
+   for (int t = 0; t < 4; t++)
+      threads.emplace_back([copy = counter, t]() mutable {
+         for (int i = 0; i < 1000; i++)
+            copy.with_write([t](std::vector<int>& v) { v.push_back(t); });
+      });
+   // readers see consistent sizes (never a vector in the middle of a push)
+   for (int i = 0; i < 100; i++) {
+      std::size_t n = counter.with_read([](const std::vector<int>& v) { return v.size(); });
+      assert(n <= 4000);
+      (void)n;
+   }
+   for (auto& t : threads)
+      t.join();
+   assert(counter.with_read([](const std::vector<int>& v) { return v.size(); }) == 4000);
+   assert(counter.use_count() == 1);
+
+   // proxies keep the lock while they exist
+   {
+      auto w = counter.write();
+      w->clear();
+      w->push_back(7);
+   }
+   {
+      auto r = counter.read();
+      assert(r->size() == 1 && (*r)[0] == 7);
+   }
+
+   // std::mutex (no shared locking) also works
+   nnptr::synchronized_sref<std::string, std::mutex> name{ std::string{ "a" } };
+   name.with_write([](std::string& s) { s += "b"; });
+   assert(*name.read() == "ab");
+
+   // assignment writes through (copy shares the object, lock included)
+   nnptr::synchronized_sref<std::string, std::mutex> alias = name;
+   alias = std::string{ "c" };
+   assert(*name.read() == "c" && name.use_count() == 2);
+
+   // moved-from handles are rebound by assignment (swap, vector erase)
+   nnptr::synchronized_sref<std::string, std::mutex> other{ std::string{ "d" } };
+   std::swap(name, other);
+   assert(*name.read() == "d");
+   // (one proxy at a time: 'other' and 'alias' now share the same lock)
+   assert(*other.read() == "c");
+   assert(*alias.read() == "c" && alias.use_count() == 2);
+
+   std::vector<nnptr::synchronized_sref<int>> v;
+   for (int i = 0; i < 4; i++)
+      v.push_back(nnptr::make_synchronized_sref<int>(i));
+   nnptr::synchronized_sref<int> keep = v.back();
+   v.erase(v.begin());
+   v.insert(v.begin(), nnptr::make_synchronized_sref<int>(9));
+   std::vector<int> values;
+   for (const auto& s : v)
+      values.push_back(*s.read());
+   assert((values == std::vector<int>{ 9, 1, 2, 3 }));
+   assert(*keep.read() == 3);
+
+   std::cout << "synchronized_sref: ok" << std::endl;
+   return 0;
+}
@@ -0,0 +1,90 @@
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <nnptr/teardown.hpp>
+#include <utility>
+#include <vector>
+
+// teardown: long chains of sref are destroyed from a worklist (no
+// recursion), all at once or in slices with a node budget
+
+struct Node
+{
+   static std::size_t destroyed;
+
+   int value;
+   std::vector<nnptr::sref<Node>> next; // empty at end of chain
+
+   explicit Node(int _value)
+     : value{ _value }
+   {}
+
+   ~Node() { destroyed++; }
+};
+
+std::size_t Node::destroyed = 0;
+
+template<class Sink>
+void
+nnptr_detach(Node& node, Sink& sink)
+{
+   for (auto& child : node.next)
+      sink(std::move(child));
+}
+
+// chain of 'n' nodes (values 0..n-1 from head)
+nnptr::sref<Node>
+make_chain(int n)
+{
+   nnptr::sref<Node> head = nnptr::make_sref<Node>(n - 1);
+   for (int i = n - 2; i >= 0; i--) {
+      nnptr::sref<Node> node = nnptr::make_sref<Node>(i);
+      node->next.push_back(std::move(head));
+      head = std::move(node); // rebinds moved-from head
+   }
+   return head;
+}
+
+int
+main()
+{
+   const int n = 300000;
+
+   // far too deep for recursive destruction (would overflow the stack)
+   nnptr::sref<Node> chain = make_chain(n);
+   assert(chain->value == 0 && chain->next[0]->value == 1);
+   nnptr::destroy(std::move(chain));
+   assert(Node::destroyed == static_cast<std::size_t>(n));
+
+   // node budget: each step() destroys at most 1000 nodes
+   Node::destroyed = 0;
+   {
+      nnptr::teardown t{ 1000 };
+      t(make_chain(n));
+      int steps = 0;
+      std::size_t before = 0;
+      bool more = true;
+      while (more) {
+         more = t.step();
+         steps++;
+         assert(Node::destroyed - before <= 1000);
+         assert(Node::destroyed > before || !more);
+         before = Node::destroyed;
+      }
+      assert(steps == n / 1000 && t.empty());
+      (void)steps;
+      (void)before;
+      assert(Node::destroyed == static_cast<std::size_t>(n));
+   }
+
+   // nodes still shared elsewhere are only released (rest of chain survives)
+   Node::destroyed = 0;
+   nnptr::sref<Node> head = make_chain(10);
+   nnptr::sref<Node> middle = head->next[0]->next[0]->next[0];
+   nnptr::destroy(std::move(head));
+   assert(Node::destroyed == 3);
+   assert(middle->value == 3 && middle->next[0]->value == 4);
+
+   std::cout << "teardown: ok" << std::endl;
+   return 0;
+}
@@ -0,0 +1,183 @@
+#ifndef NNPTR_ATOMIC_SREF_HPP
+#define NNPTR_ATOMIC_SREF_HPP
+// ====================================================
+// Atomic Not Null Shared Reference (nnptr::atomic_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// atomic_sref<T> holds an sref<T> that can be loaded, stored, exchanged
+// and compared-and-exchanged by many threads at the same time, without
+// locks (different from std::atomic<std::shared_ptr<T>> on libstdc++).
+//
+// It uses split reference counts: current value lives in a node, and a
+// single atomic word packs node pointer (lower 48 bits) with the number
+// of readers currently accessing that node (upper 16 bits). Readers
+// announce themselves with a single fetch_add, copy the value and give
+// their count back. When a node is replaced, its pending readers are
+// moved into the node's internal counter, and the last one deletes it.
+//
+// Requires 64-bit pointers with (at most) 48 significant bits.
+// ========================================================================
+
+#include <atomic>    // atomic
+#include <cstdint>   // uintptr_t
+#include <exception> // terminate
+#include <memory>    // addressof
+#include <utility>   // move
+
+namespace nnptr {
+
+namespace details {
+
+template<class T>
+struct atomic_sref_node
+{
+   sref<T> value;
+   // readers still to leave this node (after it was replaced)
+   std::atomic<long> internal{ 0 };
+
+   explicit atomic_sref_node(sref<T> _value)
+     : value{ std::move(_value) }
+   {}
+};
+
+} // namespace details
+
+template<class T>
+class atomic_sref
+{
+   static_assert(sizeof(void*) == 8, "atomic_sref requires 64-bit pointers");
+
+   using node_type = details::atomic_sref_node<T>;
+
+   static constexpr int count_shift = 48;
+   static constexpr std::uintptr_t one = std::uintptr_t{ 1 } << count_shift;
+   static constexpr std::uintptr_t pointer_mask = one - 1;
+
+public:
+   explicit atomic_sref(sref<T> desired)
+     : word_{ pack(new node_type(std::move(desired))) }
+   {}
+
+   atomic_sref(const atomic_sref&) = delete;
+   atomic_sref& operator=(const atomic_sref&) = delete;
+
+   ~atomic_sref() { delete unpack(word_.load(std::memory_order_acquire)); }
+
+   bool is_lock_free() const noexcept { return word_.is_lock_free(); }
+
+   sref<T> load() const
+   {
+      node_type* node = acquire_node();
+      sref<T> result{ node->value };
+      release_node(node);
+      return result;
+   }
+
+   void store(sref<T> desired) { exchange(std::move(desired)); }
+
+   sref<T> exchange(sref<T> desired)
+   {
+      std::uintptr_t old_word = word_.exchange(pack(new node_type(std::move(desired))), std::memory_order_acq_rel);
+      node_type* old_node = unpack(old_word);
+      // readers may still be copying old value, so it cannot be moved
+      sref<T> result{ old_node->value };
+      retire(old_node, static_cast<long>(old_word >> count_shift));
+      return result;
+   }
+
+   // replaces value with 'desired' only if current value points to the
+   // same object as 'expected' (which is not updated on failure, since
+   // sref assignment writes through: use load() again)
+   bool compare_exchange(const sref<T>& expected, sref<T> desired)
+   {
+      node_type* new_node = nullptr;
+      while (true) {
+         node_type* node = acquire_node();
+         if (std::addressof(node->value.get()) != std::addressof(expected.get())) {
+            release_node(node);
+            delete new_node;
+            return false;
+         }
+         if (!new_node)
+            new_node = new node_type(std::move(desired));
+         std::uintptr_t w = word_.load(std::memory_order_relaxed);
+         while (unpack(w) == node) {
+            if (word_.compare_exchange_weak(w, pack(new_node), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+               // pending readers, except this one
+               retire(node, static_cast<long>(w >> count_shift) - 1);
+               return true;
+            }
+         }
+         // replaced by someone else (with same object, maybe): try again
+         release_node(node);
+      }
+   }
+
+   bool compare_exchange_strong(const sref<T>& expected, sref<T> desired)
+   {
+      return compare_exchange(expected, std::move(desired));
+   }
+
+   sref<T> operator=(sref<T> desired)
+   {
+      sref<T> copy{ desired };
+      store(std::move(desired));
+      return copy;
+   }
+
+   operator sref<T>() const { return load(); }
+
+private:
+   mutable std::atomic<std::uintptr_t> word_;
+
+   static std::uintptr_t pack(node_type* node) noexcept
+   {
+      std::uintptr_t w = reinterpret_cast<std::uintptr_t>(node);
+#ifndef NO_NNPTR_CHECKS
+      if (w & ~pointer_mask)
+         std::terminate();
+#endif
+      return w;
+   }
+
+   static node_type* unpack(std::uintptr_t w) noexcept
+   {
+      return reinterpret_cast<node_type*>(w & pointer_mask);
+   }
+
+   // announces a new reader on current node
+   node_type* acquire_node() const noexcept
+   {
+      return unpack(word_.fetch_add(one, std::memory_order_acquire));
+   }
+
+   // reader leaves 'node'
+   void release_node(node_type* node) const noexcept
+   {
+      std::uintptr_t w = word_.load(std::memory_order_relaxed);
+      while (unpack(w) == node) {
+         if (word_.compare_exchange_weak(w, w - one, std::memory_order_release, std::memory_order_relaxed))
+            return;
+      }
+      // node was replaced: reader was moved into internal counter
+      if (node->internal.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         delete node;
+   }
+
+   // node was replaced while 'readers' were still accessing it
+   static void retire(node_type* node, long readers) noexcept
+   {
+      if (node->internal.fetch_add(readers, std::memory_order_acq_rel) == -readers)
+         delete node;
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_ATOMIC_SREF_HPP
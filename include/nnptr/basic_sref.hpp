@@ -0,0 +1,380 @@
+#ifndef NNPTR_BASIC_SREF_HPP
+#define NNPTR_BASIC_SREF_HPP
+// ====================================================
+// Not Null Shared Reference with custom reference counting (nnptr::basic_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, NotNull, in_place
+
+// ========================================================================
+// basic_sref<T, Count> has the same interface of sref<T>, but does not
+// depend on std::shared_ptr: reference counting strategy is given by
+// 'Count', which lives inside the control block. Object and control block
+// are allocated together when possible.
+//
+// 'Count' is required to provide:
+// - default constructor (starting at one reference)
+// - void increment() noexcept
+// - bool decrement() noexcept      (returns true when object must die)
+// - long use_count() const noexcept
+// - static constexpr bool thread_safe
+// ========================================================================
+
+#include <exception>   // terminate
+#include <memory>      // shared_ptr, unique_ptr
+#include <type_traits> // enable_if, is_convertible, integral_constant
+#include <utility>     // forward, move
+
+namespace nnptr {
+
+namespace details {
+
+// control block: counter and a way to destroy object (and itself)
+template<class Count>
+struct rc_block : public Count
+{
+   virtual void dispose() noexcept = 0;
+
+protected:
+   ~rc_block() = default;
+};
+
+// object and control block in a single allocation
+template<class Count, class X>
+struct rc_inplace_block final : public rc_block<Count>
+{
+   X value;
+
+   template<class... Args>
+   explicit rc_inplace_block(Args&&... args)
+     : value(std::forward<Args>(args)...)
+   {}
+
+   void dispose() noexcept override { delete this; }
+};
+
+// adopts an existing pointer
+template<class Count, class X>
+struct rc_pointer_block final : public rc_block<Count>
+{
+   X* ptr;
+
+   explicit rc_pointer_block(X* _ptr)
+     : ptr{ _ptr }
+   {}
+
+   void dispose() noexcept override
+   {
+      delete ptr;
+      delete this;
+   }
+};
+
+// keeps a std::shared_ptr alive (explicit conversion from sref)
+template<class Count, class X>
+struct rc_shared_block final : public rc_block<Count>
+{
+   std::shared_ptr<X> ptr;
+
+   explicit rc_shared_block(std::shared_ptr<X> _ptr)
+     : ptr{ std::move(_ptr) }
+   {}
+
+   void dispose() noexcept override { delete this; }
+};
+
+// deleter for std::shared_ptr that holds one reference of a rc_block
+template<class Count>
+struct rc_release
+{
+   rc_block<Count>* block;
+
+   template<class X>
+   void operator()(X*) const noexcept
+   {
+      if (block->decrement())
+         block->dispose();
+   }
+};
+
+// deleter for std::shared_ptr that owns a rc_block alone (no counting)
+template<class Count>
+struct rc_dispose
+{
+   rc_block<Count>* block;
+
+   template<class X>
+   void operator()(X*) const noexcept
+   {
+      block->dispose();
+   }
+};
+
+} // namespace details
+
+template<typename T, class Count>
+class basic_sref
+{
+   using block_type = details::rc_block<Count>;
+
+public:
+   using count_type = Count;
+
+   // this constructor can be used to "move" into new basic_sref versions
+   // this requires a move constructor over the type X (must be concrete)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_convertible<X*, T*>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   basic_sref(X&& other)
+   {
+      emplace<X>(std::move(other));
+   }
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_convertible<X*, T*>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   basic_sref(const X& other)
+   {
+      emplace<X>(other);
+   }
+
+   // builds object and control block in a single allocation
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit basic_sref(in_place_t, Args&&... args)
+   {
+      emplace<T>(std::forward<Args>(args)...);
+   }
+
+   basic_sref(T* data)
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (data == nullptr)
+         std::terminate();
+#endif
+      std::unique_ptr<T> guard{ data }; // in case block allocation fails
+      cb_ = new details::rc_pointer_block<Count, T>(data);
+      ptr_ = guard.release();
+   }
+
+   // disallow explicit nullptr
+   basic_sref(std::nullptr_t data) = delete;
+
+   // shares ownership with an existing sref (keeps its shared_ptr alive)
+   explicit basic_sref(const sref<T>& other)
+     : ptr_{ other.data_.get().get() }
+     , cb_{ new details::rc_shared_block<Count, T>(other.sptr()) }
+   {}
+
+   basic_sref(const basic_sref& other) noexcept
+     : ptr_{ other.ptr_ }
+     , cb_{ other.cb_ }
+   {
+      check(cb_);
+      cb_->increment();
+   }
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   basic_sref(const basic_sref<Y, Count>& other) noexcept
+     : ptr_{ other.ptr_ }
+     , cb_{ other.cb_ }
+   {
+      check(cb_);
+      cb_->increment();
+   }
+
+   // takes ownership from 'corpse' (no reference counting involved)
+   // moved-from basic_sref has no block: it can only be destroyed, or be
+   // assigned to (then it shares or takes the other block, like sref)
+   basic_sref(basic_sref&& corpse) noexcept
+     : ptr_{ corpse.ptr_ }
+     , cb_{ corpse.cb_ }
+   {
+      corpse.ptr_ = nullptr;
+      corpse.cb_ = nullptr;
+   }
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   basic_sref(basic_sref<Y, Count>&& corpse) noexcept
+     : ptr_{ corpse.ptr_ }
+     , cb_{ corpse.cb_ }
+   {
+      corpse.ptr_ = nullptr;
+      corpse.cb_ = nullptr;
+   }
+
+   ~basic_sref()
+   {
+      if (cb_ && cb_->decrement())
+         cb_->dispose();
+   }
+
+   T* operator->() { return get_ptr(); }
+
+   const T* operator->() const { return get_ptr(); }
+
+   T& operator*() { return *get_ptr(); }
+
+   const T& operator*() const { return *get_ptr(); }
+
+   T& get() { return *get_ptr(); }
+
+   const T& get() const { return *get_ptr(); }
+
+   operator T&() { return *get_ptr(); }
+
+   long use_count() const noexcept
+   {
+      check(cb_);
+      return cb_->use_count();
+   }
+
+   // shares ownership with a new sref (requires thread safe counting)
+   sref<T> to_sref() const&
+   {
+      static_assert(Count::thread_safe,
+                    "non thread safe basic_sref can only be moved into sref");
+      check(cb_);
+      cb_->increment();
+      return std::shared_ptr<T>(ptr_, details::rc_release<Count>{ cb_ });
+   }
+
+   // moves ownership into a new sref (non thread safe counting requires
+   // this to be the only reference, so the sref may travel to other threads)
+   sref<T> to_sref() &&
+   {
+      check(cb_);
+      T* ptr = ptr_;
+      block_type* cb = cb_;
+      ptr_ = nullptr;
+      cb_ = nullptr;
+      return move_to_sref(ptr, cb, std::integral_constant<bool, Count::thread_safe>{});
+   }
+
+   basic_sref& operator=(const basic_sref& other)
+   {
+      // self-reference
+      if (this == &other)
+         return *this;
+
+      // moved-from: shares the other block
+      if (!cb_) {
+         check(other.cb_);
+         ptr_ = other.ptr_;
+         cb_ = other.cb_;
+         cb_->increment();
+         return *this;
+      }
+
+      // ASSUME NON-NULL FOR operator=
+      (*get_ptr()) = (*other.get_ptr());
+
+      return *this;
+   }
+
+   // moved-from: takes the block of 'corpse' (otherwise writes through,
+   // moving the value only if 'corpse' is its last reference)
+   basic_sref& operator=(basic_sref&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (!cb_) {
+         ptr_ = corpse.ptr_;
+         cb_ = corpse.cb_;
+         corpse.ptr_ = nullptr;
+         corpse.cb_ = nullptr;
+         return *this;
+      }
+
+      // value is only moved when no other handle can see it
+      if (corpse.use_count() > 1)
+         (*get_ptr()) = (*corpse.get_ptr());
+      else
+         (*get_ptr()) = std::move(*corpse.get_ptr());
+
+      return *this;
+   }
+
+   // assignment writes through (like a reference), so no new basic_sref is created
+   basic_sref& operator=(const T& value)
+   {
+      (*get_ptr()) = value;
+      return *this;
+   }
+
+   basic_sref& operator=(T&& value)
+   {
+      (*get_ptr()) = std::move(value);
+      return *this;
+   }
+
+private:
+   template<class Y, class C>
+   friend class basic_sref;
+
+   T* ptr_;
+   block_type* cb_;
+
+   template<class X, class... Args>
+   void emplace(Args&&... args)
+   {
+      auto* block = new details::rc_inplace_block<Count, X>(std::forward<Args>(args)...);
+      ptr_ = &block->value;
+      cb_ = block;
+   }
+
+   static void check(const block_type* cb) noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (cb == nullptr)
+         std::terminate();
+#else
+      (void)cb;
+#endif
+   }
+
+   T* get_ptr() const noexcept
+   {
+      check(cb_);
+      return ptr_;
+   }
+
+   static sref<T> move_to_sref(T* ptr, block_type* cb, std::true_type)
+   {
+      return std::shared_ptr<T>(ptr, details::rc_release<Count>{ cb });
+   }
+
+   static sref<T> move_to_sref(T* ptr, block_type* cb, std::false_type)
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (cb->use_count() != 1)
+         std::terminate();
+#endif
+      return std::shared_ptr<T>(ptr, details::rc_dispose<Count>{ cb });
+   }
+};
+
+// creates a new 'basic_sref' with a single allocation
+template<class T, class Count, class... Args>
+basic_sref<T, Count>
+make_basic_sref(Args&&... args)
+{
+   return basic_sref<T, Count>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_BASIC_SREF_HPP
@@ -0,0 +1,321 @@
+#ifndef NNPTR_BIASED_SREF_HPP
+#define NNPTR_BIASED_SREF_HPP
+// ====================================================
+// Biased Reference Counting for Not Null Shared Reference (nnptr::biased_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "basic_sref.hpp" // basic_sref
+
+// ========================================================================
+// biased_count is a counting policy for basic_sref (see biased_sref<T>):
+// the thread that creates the object (owner) counts its references
+// without atomic instructions, while other threads use an atomic shared
+// counter. When owner releases its last reference, both counters are
+// merged and, from then on, every thread uses the shared counter.
+//
+// References copied by the owner may die on other threads, making the
+// shared counter negative. In this case, object is queued to the owner,
+// which merges it on its next release of any biased_sref (or explicitly
+// on nnptr::biased_collect()). Thread exit merges everything it owns.
+//
+// Reference: Choi, Shull and Torrellas, "Biased Reference Counting" (PACT 2018)
+// ========================================================================
+
+#include <atomic> // atomic
+#include <mutex>  // mutex, lock_guard
+#include <thread> // this_thread::get_id
+#include <vector> // vector
+
+namespace nnptr {
+
+class biased_count;
+
+namespace details {
+
+// per-thread bookkeeping of objects biased towards that thread
+// (registries are recycled for new threads, never released)
+class biased_registry
+{
+public:
+   static biased_registry& local()
+   {
+      static thread_local holder h{ acquire() };
+      return *h.registry;
+   }
+
+   // merges objects queued by other threads (owner only)
+   void collect() noexcept;
+
+private:
+   friend class nnptr::biased_count;
+
+   struct holder
+   {
+      biased_registry* registry;
+      ~holder() { registry->close(); }
+   };
+
+   // objects still biased (owner only)
+   biased_count* head_{ nullptr };
+   // objects queued by other threads (lock-free stack)
+   std::atomic<biased_count*> queue_{ nullptr };
+   // owner thread has finished
+   std::atomic<bool> closed_{ false };
+
+   static std::mutex& pool_mutex()
+   {
+      static std::mutex m;
+      return m;
+   }
+
+   static std::vector<biased_registry*>& pool()
+   {
+      // never destroyed (threads may finish during static destruction)
+      static std::vector<biased_registry*>* p = new std::vector<biased_registry*>;
+      return *p;
+   }
+
+   static biased_registry* acquire()
+   {
+      std::lock_guard<std::mutex> lock(pool_mutex());
+      if (pool().empty())
+         return new biased_registry;
+      biased_registry* registry = pool().back();
+      pool().pop_back();
+      registry->closed_.store(false);
+      return registry;
+   }
+
+   void push(biased_count* count) noexcept;
+   void process(biased_count* list) noexcept;
+   void close() noexcept;
+};
+
+} // namespace details
+
+class biased_count
+{
+public:
+   static constexpr bool thread_safe = true;
+
+   biased_count() noexcept
+     : owner_{ std::this_thread::get_id() }
+     , registry_{ &details::biased_registry::local() }
+   {
+      next_ = registry_->head_;
+      if (next_)
+         next_->prev_ = this;
+      registry_->head_ = this;
+   }
+
+   // only still biased if object construction failed (on owner thread)
+   ~biased_count()
+   {
+      if (!merged_.load(std::memory_order_relaxed))
+         unlink();
+   }
+
+   biased_count(const biased_count&) = delete;
+   biased_count& operator=(const biased_count&) = delete;
+
+   void increment() noexcept
+   {
+      if (owned())
+         biased_.store(biased_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      else
+         shared_.fetch_add(ONE, std::memory_order_relaxed);
+   }
+
+   bool decrement() noexcept
+   {
+      if (owned()) {
+         // merges pending objects first (this one may be among them)
+         if (registry_->queue_.load(std::memory_order_relaxed)) {
+            registry_->collect();
+            if (!owned())
+               return shared_decrement();
+         }
+         long biased = biased_.load(std::memory_order_relaxed) - 1;
+         biased_.store(biased, std::memory_order_relaxed);
+         if (biased > 0)
+            return false;
+         return merge(0, false);
+      }
+      return shared_decrement();
+   }
+
+   // approximated when called during concurrent changes
+   long use_count() const noexcept
+   {
+      return biased_.load(std::memory_order_relaxed) + count_of(shared_.load(std::memory_order_relaxed));
+   }
+
+private:
+   friend class details::biased_registry;
+
+   // shared counter holds (ONE * count + flags), where count may be negative before merge
+   static constexpr long MERGED = 1;
+   static constexpr long QUEUED = 2;
+   static constexpr long ONE = 4;
+
+   const std::thread::id owner_;
+   details::biased_registry* const registry_;
+   // only written by owner (atomic just to be readable by others)
+   std::atomic<long> biased_{ 1 };
+   std::atomic<bool> merged_{ false };
+   std::atomic<long> shared_{ 0 };
+   // list of objects biased towards owner thread
+   biased_count* prev_{ nullptr };
+   biased_count* next_{ nullptr };
+   // queue of objects to be merged by owner
+   biased_count* queued_next_{ nullptr };
+
+   static long count_of(long shared) noexcept { return (shared - (shared & (ONE - 1))) / ONE; }
+
+   bool owned() const noexcept
+   {
+      return !merged_.load(std::memory_order_relaxed) && owner_ == std::this_thread::get_id();
+   }
+
+   bool shared_decrement() noexcept
+   {
+      long old_value = shared_.load(std::memory_order_relaxed);
+      long new_value;
+      do {
+         new_value = old_value - ONE;
+         // first time count becomes negative, owner must be told to merge
+         if (!(new_value & (MERGED | QUEUED)) && count_of(new_value) < 0)
+            new_value |= QUEUED;
+      } while (!shared_.compare_exchange_weak(old_value, new_value, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+      if ((new_value & QUEUED) && !(old_value & QUEUED)) {
+         registry_->push(this);
+         return false;
+      }
+      return new_value == MERGED;
+   }
+
+   // owner gives up its bias, moving 'biased' references into shared counter
+   // returns true when there are no references left
+   bool merge(long biased, bool dequeued) noexcept
+   {
+      unlink();
+      biased_.store(0, std::memory_order_relaxed);
+      merged_.store(true, std::memory_order_relaxed);
+      long add = ONE * biased + MERGED - (dequeued ? QUEUED : 0);
+      return shared_.fetch_add(add, std::memory_order_acq_rel) + add == MERGED;
+   }
+
+   // leaves list of objects biased towards owner
+   void unlink() noexcept
+   {
+      if (prev_)
+         prev_->next_ = next_;
+      else
+         registry_->head_ = next_;
+      if (next_)
+         next_->prev_ = prev_;
+      prev_ = next_ = nullptr;
+   }
+
+   // merged object left the queue
+   // returns true when there are no references left
+   bool dequeue() noexcept
+   {
+      long old_value = shared_.load(std::memory_order_relaxed);
+      while (!shared_.compare_exchange_weak(old_value, old_value - QUEUED, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      }
+      return old_value - QUEUED == MERGED;
+   }
+
+   void dispose() noexcept;
+};
+
+namespace details {
+
+inline void
+biased_registry::collect() noexcept
+{
+   process(queue_.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+inline void
+biased_registry::push(biased_count* count) noexcept
+{
+   biased_count* head = queue_.load(std::memory_order_relaxed);
+   do {
+      count->queued_next_ = head;
+   } while (!queue_.compare_exchange_weak(head, count, std::memory_order_seq_cst, std::memory_order_relaxed));
+   // owner is gone: nobody else will process the queue
+   if (closed_.load(std::memory_order_seq_cst))
+      process(queue_.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+inline void
+biased_registry::process(biased_count* list) noexcept
+{
+   while (list) {
+      biased_count* count = list;
+      list = list->queued_next_;
+      bool dead;
+      if (count->merged_.load(std::memory_order_relaxed))
+         dead = count->dequeue();
+      else if (count->owner_ == std::this_thread::get_id())
+         dead = count->merge(count->biased_.load(std::memory_order_relaxed), true);
+      else {
+         // registry was recycled: object belongs to the new (live) owner
+         push(count);
+         continue;
+      }
+      if (dead)
+         count->dispose();
+   }
+}
+
+inline void
+biased_registry::close() noexcept
+{
+   while (head_) {
+      biased_count* count = head_;
+      if (count->merge(count->biased_.load(std::memory_order_relaxed), false))
+         count->dispose();
+   }
+   closed_.store(true, std::memory_order_seq_cst);
+   process(queue_.exchange(nullptr, std::memory_order_acq_rel));
+
+   std::lock_guard<std::mutex> lock(pool_mutex());
+   pool().push_back(this);
+}
+
+} // namespace details
+
+inline void
+biased_count::dispose() noexcept
+{
+   static_cast<details::rc_block<biased_count>*>(this)->dispose();
+}
+
+// merges objects that other threads have queued to current thread
+inline void
+biased_collect() noexcept
+{
+   details::biased_registry::local().collect();
+}
+
+template<typename T>
+using biased_sref = basic_sref<T, biased_count>;
+
+// creates a new 'biased_sref' (biased towards current thread) with a single allocation
+template<class T, class... Args>
+biased_sref<T>
+make_biased_sref(Args&&... args)
+{
+   return biased_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_BIASED_SREF_HPP
@@ -0,0 +1,105 @@
+#ifndef NNPTR_BOXED_HPP
+#define NNPTR_BOXED_HPP
+// ====================================================
+// Boxed Scalar Cache of Not Null Shared References (nnptr::box)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, make_sref
+
+// ========================================================================
+// box(value) gives an sref<const T> for a scalar (like Java Integer cache):
+// common values come from a preallocated table of immortal srefs (see
+// sref<T>::immortal), so there is no allocation and no reference counting.
+// Other values get a new sref (single allocation, as make_sref).
+//
+// Whole values in boxed_range<T> are cached: -128..127 by default (clipped
+// to the type, 0..1 for bool). Specialize boxed_range<T> to change it
+// (set min > max to disable it). Table is built on first use of each type.
+// ========================================================================
+
+#include <climits>     // LLONG_MAX
+#include <cmath>       // signbit
+#include <type_traits> // is_arithmetic, is_integral, is_signed, is_unsigned, is_same
+
+namespace nnptr {
+
+template<class T>
+struct boxed_range
+{
+   static constexpr long long min = std::is_signed<T>::value ? -128 : 0;
+   static constexpr long long max = std::is_same<T, bool>::value ? 1 : 127;
+};
+
+namespace details {
+
+template<class T>
+struct boxed_table
+{
+   static constexpr long long min = boxed_range<T>::min;
+   static constexpr long long size = boxed_range<T>::max >= min ? boxed_range<T>::max - min + 1 : 0;
+
+   T values[size > 0 ? size : 1];
+
+   boxed_table()
+   {
+      for (long long i = 0; i < size; i++)
+         values[i] = static_cast<T>(min + i);
+   }
+};
+
+// position of 'value' in boxed_table<T> (false if it is not cached)
+template<class T>
+bool
+boxed_index(T value, long long& index, std::true_type) // integral
+{
+   const long long min = boxed_range<T>::min;
+   const long long max = boxed_range<T>::max;
+   if (std::is_unsigned<T>::value && static_cast<unsigned long long>(value) > static_cast<unsigned long long>(LLONG_MAX))
+      return false;
+   const long long x = static_cast<long long>(value);
+   if (x < min || x > max)
+      return false;
+   index = x - min;
+   return true;
+}
+
+template<class T>
+bool
+boxed_index(T value, long long& index, std::false_type) // floating point
+{
+   const long long min = boxed_range<T>::min;
+   const long long max = boxed_range<T>::max;
+   // also false for NaN
+   if (!(value >= static_cast<T>(min) && value <= static_cast<T>(max)))
+      return false;
+   const long long x = static_cast<long long>(value);
+   // only whole values (and not -0.0)
+   if (static_cast<T>(x) != value || (x == 0 && std::signbit(value)))
+      return false;
+   index = x - min;
+   return true;
+}
+
+} // namespace details
+
+// sref<const T> of 'value' (shared immortal instance, when it is cached)
+template<class T>
+sref<const T>
+box(T value)
+{
+   static_assert(std::is_arithmetic<T>::value, "box only supports scalars (see sref_factory_cache)");
+   long long index;
+   if (details::boxed_index(value, index, std::is_integral<T>{})) {
+      // never destroyed (srefs to it may live until program exit)
+      static const details::boxed_table<T>* table = new details::boxed_table<T>{};
+      return sref<const T>::immortal(table->values[index]);
+   }
+   return make_sref<const T>(value);
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_BOXED_HPP
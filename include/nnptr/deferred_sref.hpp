@@ -0,0 +1,294 @@
+#ifndef NNPTR_DEFERRED_SREF_HPP
+#define NNPTR_DEFERRED_SREF_HPP
+// ====================================================
+// Deferred Reference Counting for Not Null Shared Reference (nnptr::deferred_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "basic_sref.hpp" // basic_sref
+
+// ========================================================================
+// deferred_count is a counting policy for basic_sref (see deferred_sref<T>):
+// releases are not applied to the shared counter, but logged on a
+// thread-local buffer. A new copy on the same thread cancels a logged
+// release, so temporary copies that come and go never touch the shared
+// counter. Logged releases are applied in batch on nnptr::flush() (or at
+// the end of a nnptr::deferred_scope, or on thread exit), which is the
+// point where objects are destroyed.
+//
+// Only releases are deferred (copies are always visible to other
+// threads), so the shared counter is never below the real number of
+// references and objects never die too early.
+//
+// Releases after the thread-local log is gone (during thread exit, or
+// static destruction on main thread) are applied at once, and so are
+// releases that cannot be logged for lack of memory.
+// ========================================================================
+
+#include <atomic>  // atomic
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t, uintptr_t
+#include <new>     // nothrow
+
+namespace nnptr {
+
+class deferred_count;
+
+namespace details {
+
+// thread-local table of pending releases (open addressing, keyed by block)
+// so logging, cancelling and looking up a release take constant time
+class deferred_log
+{
+public:
+   // log of current thread, or nullptr after it was destroyed (thread exit)
+   static deferred_log* local() noexcept
+   {
+      if (closed())
+         return nullptr;
+      static thread_local deferred_log log;
+      return &log;
+   }
+
+   deferred_log() = default;
+   deferred_log(const deferred_log&) = delete;
+   deferred_log& operator=(const deferred_log&) = delete;
+
+   ~deferred_log()
+   {
+      flush();
+      closed() = true;
+      delete[] table_;
+      delete[] spare_;
+   }
+
+   // logs one release of 'count' (returns false if log cannot grow)
+   bool defer(deferred_count* count) noexcept
+   {
+      entry* e = find(count);
+      if (e) {
+         e->pending++;
+         return true;
+      }
+      if (2 * (size_ + 1) > capacity_ && !grow())
+         return false;
+      place(entry{ count, 1 });
+      size_++;
+      return true;
+   }
+
+   // cancels one logged release of 'count' (returns false if none)
+   bool cancel(deferred_count* count) noexcept
+   {
+      entry* e = find(count);
+      if (!e)
+         return false;
+      if (--e->pending == 0)
+         remove(e);
+      return true;
+   }
+
+   long pending(const deferred_count* count) const noexcept
+   {
+      const entry* e = const_cast<deferred_log*>(this)->find(count);
+      return e ? e->pending : 0;
+   }
+
+   void flush() noexcept;
+
+private:
+   struct entry
+   {
+      deferred_count* count; // nullptr on empty slots
+      long pending;
+   };
+
+   entry* table_{ nullptr };
+   std::size_t capacity_{ 0 }; // zero or a power of two
+   std::size_t size_{ 0 };
+   entry* spare_{ nullptr }; // table kept between flushes (avoids allocations)
+   std::size_t spare_capacity_{ 0 };
+
+   // trivially destructible, so it can still be read after the log is gone
+   static bool& closed() noexcept
+   {
+      static thread_local bool flag = false;
+      return flag;
+   }
+
+   std::size_t home(const deferred_count* count) const noexcept
+   {
+      // mixes pointer bits (blocks are aligned)
+      std::uint64_t h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(count)) * 0x9E3779B97F4A7C15ull;
+      return static_cast<std::size_t>(h >> 32) & (capacity_ - 1);
+   }
+
+   entry* find(const deferred_count* count) noexcept
+   {
+      if (size_ == 0)
+         return nullptr;
+      for (std::size_t i = home(count);; i = (i + 1) & (capacity_ - 1)) {
+         if (table_[i].count == count)
+            return &table_[i];
+         if (!table_[i].count)
+            return nullptr;
+      }
+   }
+
+   void place(entry e) noexcept
+   {
+      std::size_t i = home(e.count);
+      while (table_[i].count)
+         i = (i + 1) & (capacity_ - 1);
+      table_[i] = e;
+   }
+
+   // backward shift deletion (keeps every probe sequence unbroken)
+   void remove(entry* e) noexcept
+   {
+      std::size_t mask = capacity_ - 1;
+      std::size_t i = static_cast<std::size_t>(e - table_);
+      for (std::size_t j = (i + 1) & mask; table_[j].count; j = (j + 1) & mask) {
+         std::size_t k = home(table_[j].count);
+         // entry at 'j' may move back to 'i' if its home is not in (i, j]
+         if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+            table_[i] = table_[j];
+            i = j;
+         }
+      }
+      table_[i].count = nullptr;
+      size_--;
+   }
+
+   bool grow() noexcept
+   {
+      std::size_t capacity = capacity_ ? 2 * capacity_ : 64;
+      entry* table;
+      if (!table_ && spare_ && spare_capacity_ >= capacity) {
+         table = spare_;
+         capacity = spare_capacity_;
+         spare_ = nullptr;
+      } else {
+         table = new (std::nothrow) entry[capacity]();
+         if (!table)
+            return false;
+      }
+      entry* old = table_;
+      std::size_t old_capacity = capacity_;
+      table_ = table;
+      capacity_ = capacity;
+      for (std::size_t i = 0; i < old_capacity; i++)
+         if (old[i].count)
+            place(old[i]);
+      delete[] old;
+      return true;
+   }
+};
+
+} // namespace details
+
+class deferred_count
+{
+public:
+   static constexpr bool thread_safe = true;
+
+   void increment() noexcept
+   {
+      details::deferred_log* log = details::deferred_log::local();
+      if (!log || !log->cancel(this))
+         count_.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // object dies on next flush (or here, if release cannot be logged)
+   bool decrement() noexcept
+   {
+      details::deferred_log* log = details::deferred_log::local();
+      if (log && log->defer(this))
+         return false;
+      return release(1);
+   }
+
+   // discounts releases pending on current thread (not on others)
+   long use_count() const noexcept
+   {
+      const details::deferred_log* log = details::deferred_log::local();
+      return count_.load(std::memory_order_relaxed) - (log ? log->pending(this) : 0);
+   }
+
+private:
+   friend class details::deferred_log;
+
+   std::atomic<long> count_{ 1 };
+
+   // applies 'n' releases (returns true when object must die)
+   bool release(long n) noexcept
+   {
+      return count_.fetch_sub(n, std::memory_order_acq_rel) == n;
+   }
+};
+
+namespace details {
+
+inline void
+deferred_log::flush() noexcept
+{
+   // destructors may log new releases, so keep going until nothing is left
+   while (size_ > 0) {
+      entry* batch = table_;
+      std::size_t batch_capacity = capacity_;
+      table_ = nullptr;
+      capacity_ = 0;
+      size_ = 0;
+      for (std::size_t i = 0; i < batch_capacity; i++)
+         if (batch[i].count && batch[i].count->release(batch[i].pending))
+            static_cast<rc_block<deferred_count>*>(batch[i].count)->dispose();
+      // keeps largest table for next releases
+      for (std::size_t i = 0; i < batch_capacity; i++)
+         batch[i].count = nullptr;
+      if (!spare_ || spare_capacity_ < batch_capacity) {
+         delete[] spare_;
+         spare_ = batch;
+         spare_capacity_ = batch_capacity;
+      } else
+         delete[] batch;
+   }
+}
+
+} // namespace details
+
+template<typename T>
+using deferred_sref = basic_sref<T, deferred_count>;
+
+// creates a new 'deferred_sref' with a single allocation
+template<class T, class... Args>
+deferred_sref<T>
+make_deferred_sref(Args&&... args)
+{
+   return deferred_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+// applies all releases logged by current thread (unused objects die here)
+inline void
+flush() noexcept
+{
+   details::deferred_log* log = details::deferred_log::local();
+   if (log)
+      log->flush();
+}
+
+// flushes current thread at the end of scope (such as the end of a task)
+class deferred_scope
+{
+public:
+   deferred_scope() = default;
+   deferred_scope(const deferred_scope&) = delete;
+   deferred_scope& operator=(const deferred_scope&) = delete;
+
+   ~deferred_scope() { flush(); }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_DEFERRED_SREF_HPP
@@ -0,0 +1,334 @@
+#ifndef NNPTR_EPOCH_DOMAIN_HPP
+#define NNPTR_EPOCH_DOMAIN_HPP
+// ====================================================
+// Epoch-Based Reclamation for Not Null Shared Reference (nnptr::epoch_domain)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// epoch_domain lets readers access shared objects through plain pointers
+// and references (no reference counting at all), as long as they stay
+// inside an epoch_guard. Objects retired into the domain (or srefs created
+// by domain.make_sref<T>(), when the last reference is dropped) are only
+// freed after every guard that could have seen them is gone.
+//
+// Readers announce the global epoch on their own (thread) record when
+// entering a guard. Global epoch only advances when all active readers
+// have announced it, so objects retired on epoch 'e' are freed when global
+// epoch reaches 'e + 2'. Retired objects wait on a list (under a mutex,
+// writer side only) and are freed in batches.
+//
+// A domain must outlive all its guards and retired objects (see
+// default_epoch_domain(), which lives until the end of the program).
+// ========================================================================
+
+#include <algorithm>   // partition
+#include <atomic>      // atomic, atomic_thread_fence
+#include <cstddef>     // size_t
+#include <cstdint>     // uint64_t
+#include <exception>   // terminate
+#include <memory>      // shared_ptr, unique_ptr
+#include <mutex>       // mutex, lock_guard
+#include <thread>      // this_thread::yield
+#include <utility>     // forward, move
+#include <vector>      // vector
+
+namespace nnptr {
+
+namespace details {
+
+// per-thread announcement (records are recycled when threads finish)
+struct epoch_record
+{
+   // announced epoch (0 when not inside a guard)
+   std::atomic<std::uint64_t> epoch{ 0 };
+   std::atomic<bool> in_use{ true };
+   // nested guards (only touched by owner thread)
+   unsigned depth{ 0 };
+   epoch_record* next{ nullptr };
+   // avoids false sharing between records (64 bytes cache line)
+   char padding[64];
+};
+
+// domains alive (so finishing threads never touch records of dead domains)
+struct epoch_domains
+{
+   std::mutex mutex;
+   std::vector<std::uint64_t> alive;
+   std::uint64_t next_id{ 1 };
+
+   static epoch_domains& instance()
+   {
+      // never destroyed, since threads may finish after static destructors
+      static epoch_domains* domains = new epoch_domains{};
+      return *domains;
+   }
+
+   bool is_alive(std::uint64_t id) const noexcept
+   {
+      return std::find(alive.begin(), alive.end(), id) != alive.end();
+   }
+};
+
+// records taken by current thread (one per domain)
+struct epoch_thread_records
+{
+   struct entry
+   {
+      std::uint64_t domain_id;
+      epoch_record* record;
+   };
+
+   std::vector<entry> entries;
+
+   static epoch_thread_records& local()
+   {
+      static thread_local epoch_thread_records records;
+      return records;
+   }
+
+   ~epoch_thread_records()
+   {
+      auto& domains = epoch_domains::instance();
+      std::lock_guard<std::mutex> lock{ domains.mutex };
+      for (const auto& e : entries)
+         if (domains.is_alive(e.domain_id))
+            e.record->in_use.store(false, std::memory_order_release);
+   }
+};
+
+} // namespace details
+
+class epoch_guard;
+
+class epoch_domain
+{
+public:
+   // 'threshold' is the number of retired objects that triggers a collection
+   explicit epoch_domain(std::size_t threshold = 64)
+     : threshold_{ threshold }
+   {
+      auto& domains = details::epoch_domains::instance();
+      std::lock_guard<std::mutex> lock{ domains.mutex };
+      id_ = domains.next_id++;
+      domains.alive.push_back(id_);
+   }
+
+   epoch_domain(const epoch_domain&) = delete;
+   epoch_domain& operator=(const epoch_domain&) = delete;
+
+   // no guards may be active here: all retired objects are freed
+   ~epoch_domain()
+   {
+      {
+         auto& domains = details::epoch_domains::instance();
+         std::lock_guard<std::mutex> lock{ domains.mutex };
+         domains.alive.erase(std::find(domains.alive.begin(), domains.alive.end(), id_));
+      }
+      // deleters may retire other objects
+      while (true) {
+         std::vector<retired> batch;
+         {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            batch.swap(retired_);
+         }
+         if (batch.empty())
+            break;
+         for (const auto& r : batch)
+            r.deleter(r.ptr);
+      }
+      details::epoch_record* rec = head_.load(std::memory_order_acquire);
+      while (rec) {
+         details::epoch_record* next = rec->next;
+         delete rec;
+         rec = next;
+      }
+   }
+
+   // frees 'ptr' with 'deleter' when no guard can see it anymore
+   void retire(void* ptr, void (*deleter)(void*))
+   {
+      std::size_t n;
+      {
+         std::lock_guard<std::mutex> lock{ mutex_ };
+         retired_.push_back(retired{ global_.load(std::memory_order_seq_cst), ptr, deleter });
+         n = retired_.size();
+      }
+      if (n >= threshold_)
+         collect();
+   }
+
+   template<class T>
+   void retire(T* ptr)
+   {
+      retire(static_cast<void*>(ptr), [](void* p) { delete static_cast<T*>(p); });
+   }
+
+   // drops reference 'ref' when no guard can see it anymore
+   template<class T>
+   void retire(sref<T> ref)
+   {
+      retire(new sref<T>{ std::move(ref) });
+   }
+
+   // creates a new 'sref' whose object is retired into this domain (instead
+   // of deleted) when the last reference is dropped
+   template<class T, class... Args>
+   sref<T> make_sref(Args&&... args)
+   {
+      std::unique_ptr<T> obj{ new T(std::forward<Args>(args)...) };
+      epoch_domain* domain = this;
+      return sref<T>{ std::shared_ptr<T>(obj.release(), [domain](T* p) { domain->retire(p); }) };
+   }
+
+   // tries to advance global epoch and frees objects no guard can see
+   void collect()
+   {
+      try_advance();
+      std::uint64_t global = global_.load(std::memory_order_acquire);
+      std::vector<retired> ready;
+      {
+         std::lock_guard<std::mutex> lock{ mutex_ };
+         auto it = std::partition(retired_.begin(), retired_.end(), [global](const retired& r) {
+            return r.epoch + 2 > global;
+         });
+         ready.assign(it, retired_.end());
+         retired_.erase(it, retired_.end());
+      }
+      for (const auto& r : ready)
+         r.deleter(r.ptr);
+   }
+
+   // waits for all current guards to finish and frees everything retired
+   // so far (objects retired by those deleters may still be pending)
+   // cannot be called inside a guard of this domain
+   void synchronize()
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (local_record().depth > 0)
+         std::terminate();
+#endif
+      std::uint64_t target = global_.load(std::memory_order_seq_cst) + 2;
+      while (global_.load(std::memory_order_acquire) < target)
+         if (!try_advance())
+            std::this_thread::yield();
+      collect();
+   }
+
+   // number of retired objects still waiting to be freed
+   std::size_t pending() const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return retired_.size();
+   }
+
+private:
+   friend class epoch_guard;
+
+   struct retired
+   {
+      std::uint64_t epoch;
+      void* ptr;
+      void (*deleter)(void*);
+   };
+
+   std::atomic<std::uint64_t> global_{ 1 };
+   std::atomic<details::epoch_record*> head_{ nullptr };
+   std::uint64_t id_;
+   std::size_t threshold_;
+   mutable std::mutex mutex_;
+   std::vector<retired> retired_;
+
+   details::epoch_record& local_record()
+   {
+      auto& records = details::epoch_thread_records::local();
+      for (const auto& e : records.entries)
+         if (e.domain_id == id_)
+            return *e.record;
+      details::epoch_record* rec = acquire_record();
+      records.entries.push_back({ id_, rec });
+      return *rec;
+   }
+
+   // reuses a record from a finished thread, or creates a new one
+   details::epoch_record* acquire_record()
+   {
+      for (auto* rec = head_.load(std::memory_order_acquire); rec; rec = rec->next) {
+         bool expected = false;
+         if (!rec->in_use.load(std::memory_order_relaxed) &&
+             rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return rec;
+      }
+      auto* rec = new details::epoch_record{};
+      rec->next = head_.load(std::memory_order_relaxed);
+      while (!head_.compare_exchange_weak(rec->next, rec, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+      return rec;
+   }
+
+   // advances global epoch when all active readers have announced it
+   bool try_advance() noexcept
+   {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::uint64_t global = global_.load(std::memory_order_seq_cst);
+      for (auto* rec = head_.load(std::memory_order_acquire); rec; rec = rec->next) {
+         std::uint64_t local = rec->epoch.load(std::memory_order_seq_cst);
+         if (local != 0 && local != global)
+            return false;
+      }
+      global_.compare_exchange_strong(global, global + 1, std::memory_order_seq_cst);
+      return true;
+   }
+};
+
+// epoch_domain that lives until the end of the program
+inline epoch_domain&
+default_epoch_domain()
+{
+   // never destroyed, since threads may finish after static destructors
+   static epoch_domain* domain = new epoch_domain{};
+   return *domain;
+}
+
+// objects retired into 'domain' are not freed while this guard exists
+// (guards can be nested, and only touch a record of current thread)
+class epoch_guard
+{
+public:
+   explicit epoch_guard(epoch_domain& domain = default_epoch_domain())
+     : record_{ &domain.local_record() }
+   {
+      if (record_->depth++ == 0) {
+         record_->epoch.store(domain.global_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+         // announcement must be visible before any shared pointer is read
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+   }
+
+   epoch_guard(const epoch_guard&) = delete;
+   epoch_guard& operator=(const epoch_guard&) = delete;
+
+   // moved-from guard protects nothing (must stay on the same thread)
+   epoch_guard(epoch_guard&& corpse) noexcept
+     : record_{ corpse.record_ }
+   {
+      corpse.record_ = nullptr;
+   }
+
+   ~epoch_guard()
+   {
+      if (record_ && --record_->depth == 0)
+         record_->epoch.store(0, std::memory_order_release);
+   }
+
+private:
+   details::epoch_record* record_;
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_EPOCH_DOMAIN_HPP
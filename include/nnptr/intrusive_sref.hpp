@@ -0,0 +1,297 @@
+#ifndef NNPTR_INTRUSIVE_SREF_HPP
+#define NNPTR_INTRUSIVE_SREF_HPP
+// ====================================================
+// Intrusive Not Null Shared Reference (nnptr::intrusive_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, in_place
+
+// ========================================================================
+// intrusive_sref<T> behaves as sref<T>, but reference count lives inside
+// the object itself, so handle has the size of a single pointer and no
+// separate control block is allocated.
+//
+// Type T must provide hooks (found by ADL, or through a specialization
+// of nnptr::intrusive_sref_traits<T>):
+// - void nnptr_add_ref(const T*) noexcept
+// - void nnptr_release(const T*) noexcept   (destroys object on last release)
+// - long nnptr_use_count(const T*) noexcept
+//
+// Easiest way is to inherit from nnptr::intrusive_counter<T> (CRTP).
+// Conversions to base classes require a virtual destructor on the base
+// that owns the counter (same as deleting through a base pointer).
+// ========================================================================
+
+#include <atomic>      // atomic
+#include <exception>   // terminate
+#include <memory>      // shared_ptr
+#include <type_traits> // enable_if, is_convertible
+#include <utility>     // forward, move
+
+namespace nnptr {
+
+namespace details {
+
+template<bool ThreadSafe>
+class intrusive_count
+{
+public:
+   void increment() noexcept { count_.fetch_add(1, std::memory_order_relaxed); }
+   bool decrement() noexcept { return count_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+   long load() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+private:
+   std::atomic<long> count_{ 0 };
+};
+
+template<>
+class intrusive_count<false>
+{
+public:
+   void increment() noexcept { ++count_; }
+   bool decrement() noexcept { return --count_ == 0; }
+   long load() const noexcept { return count_; }
+
+private:
+   long count_{ 0 };
+};
+
+} // namespace details
+
+// CRTP base that embeds reference counter into 'Derived'
+template<class Derived, bool ThreadSafe = true>
+class intrusive_counter
+{
+protected:
+   intrusive_counter() noexcept = default;
+
+   // copies of the object are not shared by anyone (yet)
+   intrusive_counter(const intrusive_counter&) noexcept {}
+
+   intrusive_counter& operator=(const intrusive_counter&) noexcept { return *this; }
+
+   ~intrusive_counter() = default;
+
+private:
+   mutable details::intrusive_count<ThreadSafe> count_;
+
+   friend void nnptr_add_ref(const intrusive_counter* p) noexcept
+   {
+      p->count_.increment();
+   }
+
+   friend void nnptr_release(const intrusive_counter* p) noexcept
+   {
+      if (p->count_.decrement())
+         delete static_cast<const Derived*>(p);
+   }
+
+   friend long nnptr_use_count(const intrusive_counter* p) noexcept
+   {
+      return p->count_.load();
+   }
+};
+
+// default hooks are found by ADL
+template<class T>
+struct intrusive_sref_traits
+{
+   static void add_ref(const T* p) noexcept { nnptr_add_ref(p); }
+   static void release(const T* p) noexcept { nnptr_release(p); }
+   static long use_count(const T* p) noexcept { return nnptr_use_count(p); }
+};
+
+template<typename T>
+class intrusive_sref
+{
+   using traits = intrusive_sref_traits<T>;
+
+public:
+   // this constructor can be used to "move" into new intrusive_sref versions
+   // this requires a move constructor over the type X (must be concrete)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_convertible<X*, T*>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   intrusive_sref(X&& other)
+     : intrusive_sref(new X(std::move(other)))
+   {}
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_convertible<X*, T*>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   intrusive_sref(const X& other)
+     : intrusive_sref(new X(other))
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit intrusive_sref(in_place_t, Args&&... args)
+     : intrusive_sref(new T(std::forward<Args>(args)...))
+   {}
+
+   // adopts object (its counter is incremented, so 'this' may be used)
+   intrusive_sref(T* data)
+     : ptr_{ data }
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (ptr_ == nullptr)
+         std::terminate();
+#endif
+      traits::add_ref(ptr_);
+   }
+
+   // disallow explicit nullptr
+   intrusive_sref(std::nullptr_t data) = delete;
+
+   intrusive_sref(const intrusive_sref& other) noexcept
+     : ptr_{ other.get_ptr() }
+   {
+      traits::add_ref(ptr_);
+   }
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   intrusive_sref(const intrusive_sref<Y>& other) noexcept
+     : ptr_{ other.get_ptr() }
+   {
+      traits::add_ref(ptr_);
+   }
+
+   // takes ownership from 'corpse' (no reference counting involved)
+   // moved-from intrusive_sref holds no object: it can only be destroyed,
+   // or be assigned to (then it refers to the other object, like sref)
+   intrusive_sref(intrusive_sref&& corpse) noexcept
+     : ptr_{ corpse.ptr_ }
+   {
+      corpse.ptr_ = nullptr;
+   }
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   intrusive_sref(intrusive_sref<Y>&& corpse) noexcept
+     : ptr_{ corpse.ptr_ }
+   {
+      corpse.ptr_ = nullptr;
+   }
+
+   ~intrusive_sref()
+   {
+      if (ptr_)
+         traits::release(ptr_);
+   }
+
+   T* operator->() { return get_ptr(); }
+
+   const T* operator->() const { return get_ptr(); }
+
+   T& operator*() { return *get_ptr(); }
+
+   const T& operator*() const { return *get_ptr(); }
+
+   T& get() { return *get_ptr(); }
+
+   const T& get() const { return *get_ptr(); }
+
+   operator T&() { return *get_ptr(); }
+
+   long use_count() const noexcept { return traits::use_count(get_ptr()); }
+
+   // shares ownership with a new sref (allocates a std::shared_ptr control block)
+   sref<T> to_sref() const
+   {
+      T* ptr = get_ptr();
+      traits::add_ref(ptr);
+      return std::shared_ptr<T>(ptr, [](T* p) { traits::release(p); });
+   }
+
+   intrusive_sref& operator=(const intrusive_sref& other)
+   {
+      // self-reference
+      if (this == &other)
+         return *this;
+
+      // moved-from: adds a reference to the other object
+      if (!ptr_) {
+         ptr_ = other.get_ptr();
+         traits::add_ref(ptr_);
+         return *this;
+      }
+
+      // ASSUME NON-NULL FOR operator=
+      (*get_ptr()) = (*other.get_ptr());
+
+      return *this;
+   }
+
+   // moved-from: takes the reference of 'corpse' (otherwise writes through,
+   // moving the value only if 'corpse' is its last owner)
+   intrusive_sref& operator=(intrusive_sref&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (!ptr_) {
+         ptr_ = corpse.ptr_;
+         corpse.ptr_ = nullptr;
+         return *this;
+      }
+
+      // value is only moved when no other owner can see it
+      if (corpse.use_count() > 1)
+         (*get_ptr()) = (*corpse.get_ptr());
+      else
+         (*get_ptr()) = std::move(*corpse.get_ptr());
+
+      return *this;
+   }
+
+   // assignment writes through (like a reference), so no new intrusive_sref is created
+   intrusive_sref& operator=(const T& value)
+   {
+      (*get_ptr()) = value;
+      return *this;
+   }
+
+   intrusive_sref& operator=(T&& value)
+   {
+      (*get_ptr()) = std::move(value);
+      return *this;
+   }
+
+private:
+   template<class Y>
+   friend class intrusive_sref;
+
+   T* ptr_;
+
+   T* get_ptr() const noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (ptr_ == nullptr)
+         std::terminate();
+#endif
+      return ptr_;
+   }
+};
+
+// creates a new 'intrusive_sref' (object already holds its own counter)
+template<class T, class... Args>
+intrusive_sref<T>
+make_intrusive_sref(Args&&... args)
+{
+   return intrusive_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_INTRUSIVE_SREF_HPP
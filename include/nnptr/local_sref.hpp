@@ -0,0 +1,84 @@
+#ifndef NNPTR_LOCAL_SREF_HPP
+#define NNPTR_LOCAL_SREF_HPP
+// ====================================================
+// Single-threaded Not Null Shared Reference (nnptr::local_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "basic_sref.hpp" // basic_sref
+
+// ========================================================================
+// local_sref<T> behaves as sref<T>, but reference count is not atomic:
+// all copies of a local_sref must live on the same thread.
+// On Debug (without NO_NNPTR_CHECKS), every copy/release checks that it
+// happens on the thread that created the object (otherwise, terminate).
+//
+// Conversions with sref are explicit:
+// - local_sref<T>{ some_sref }   shares ownership with a (thread safe) sref
+// - std::move(local).to_sref()   requires 'local' to be the only reference
+// ========================================================================
+
+#ifndef NO_NNPTR_CHECKS
+#include <exception> // terminate
+#include <thread>    // this_thread::get_id
+#endif
+
+namespace nnptr {
+
+class local_count
+{
+public:
+   static constexpr bool thread_safe = false;
+
+   local_count() noexcept
+     : count_{ 1 }
+#ifndef NO_NNPTR_CHECKS
+     , owner_{ std::this_thread::get_id() }
+#endif
+   {}
+
+   void increment() noexcept
+   {
+      check_thread();
+      ++count_;
+   }
+
+   bool decrement() noexcept
+   {
+      check_thread();
+      return --count_ == 0;
+   }
+
+   long use_count() const noexcept { return count_; }
+
+private:
+   long count_;
+#ifndef NO_NNPTR_CHECKS
+   std::thread::id owner_;
+#endif
+
+   void check_thread() const noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (owner_ != std::this_thread::get_id())
+         std::terminate();
+#endif
+   }
+};
+
+template<typename T>
+using local_sref = basic_sref<T, local_count>;
+
+// creates a new 'local_sref' with a single allocation
+template<class T, class... Args>
+local_sref<T>
+make_local_sref(Args&&... args)
+{
+   return local_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_LOCAL_SREF_HPP
@@ -0,0 +1,275 @@
+#ifndef NNPTR_LRU_CACHE_HPP
+#define NNPTR_LRU_CACHE_HPP
+// ====================================================
+// Concurrent LRU Cache of Not Null Shared References (nnptr::lru_cache)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// lru_cache<K, V> keeps expensive immutable values as sref<const V>.
+// Keys are split into shards (each one with its own lock and LRU list), so
+// lookups from different threads rarely meet on the same lock and never
+// on a global one.
+//
+// Each entry has a size (1 by default) and shards evict least recently
+// used entries when their share of total capacity is exceeded. Entries
+// may also expire after a time-to-live. Evicted values that are still in
+// use stay alive (they are shared), the cache only drops its reference.
+//
+// Number of shards is reduced for small capacities, so every shard gets at
+// least min_shard_capacity. An entry larger than max_entry_size() (the
+// capacity of the smallest shard) is never cached: put() returns false and
+// it is counted in stats().rejections.
+// ========================================================================
+
+#include <chrono>        // steady_clock
+#include <cstddef>       // size_t
+#include <cstdint>       // uint64_t
+#include <functional>    // hash, equal_to
+#include <list>          // list
+#include <memory>        // unique_ptr
+#include <mutex>         // mutex, lock_guard
+#include <unordered_map> // unordered_map
+#include <utility>       // forward, move
+
+namespace nnptr {
+
+// counters of an lru_cache (summed over all shards)
+struct lru_cache_stats
+{
+   std::uint64_t hits;
+   std::uint64_t misses;
+   std::uint64_t evictions;   // entries dropped to make room
+   std::uint64_t expirations; // entries dropped after their time-to-live
+   std::uint64_t rejections;  // entries larger than max_entry_size()
+   std::size_t entries;
+   std::size_t size; // sum of entry sizes
+};
+
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class lru_cache
+{
+public:
+   using clock = std::chrono::steady_clock;
+   using value_type = sref<const V>;
+
+   static constexpr std::size_t min_shard_capacity = 16;
+
+   // 'capacity' is the maximum sum of entry sizes (split among shards)
+   explicit lru_cache(std::size_t capacity,
+                      std::size_t n_shards = 16,
+                      clock::duration ttl = clock::duration::max())
+     : n_shards_{ shards_for(capacity, n_shards) }
+     , shards_{ new shard[n_shards_] }
+     , ttl_{ ttl }
+   {
+      // exact split (sum of shard capacities is 'capacity')
+      for (std::size_t i = 0; i < n_shards_; i++)
+         shards_[i].capacity = capacity / n_shards_ + (i < capacity % n_shards_ ? 1 : 0);
+   }
+
+   lru_cache(const lru_cache&) = delete;
+   lru_cache& operator=(const lru_cache&) = delete;
+
+   // writes value of 'key' into '*out' (such as a std::back_inserter) when
+   // it is cached, since sref cannot be empty (returns false on a miss)
+   template<class OutputIt>
+   bool try_get(const K& key, OutputIt out)
+   {
+      shard& s = shard_of(key);
+      std::lock_guard<std::mutex> lock{ s.mutex };
+      entry* e = s.find(key, ttl_);
+      if (!e) {
+         s.misses++;
+         return false;
+      }
+      s.hits++;
+      *out = value_type{ e->value };
+      return true;
+   }
+
+   // cached value of 'key', or the sref<const V> given by 'loader()'
+   // (called without any lock, so concurrent misses may load the same key
+   // more than once: first value inserted wins)
+   template<class F>
+   value_type get_or_load(const K& key, F&& loader, std::size_t size = 1)
+   {
+      shard& s = shard_of(key);
+      {
+         std::lock_guard<std::mutex> lock{ s.mutex };
+         entry* e = s.find(key, ttl_);
+         if (e) {
+            s.hits++;
+            return value_type{ e->value };
+         }
+         s.misses++;
+      }
+      value_type loaded{ std::forward<F>(loader)() };
+      std::lock_guard<std::mutex> lock{ s.mutex };
+      entry* e = s.find(key, ttl_);
+      if (e)
+         return value_type{ e->value };
+      s.insert(key, loaded, size, expiry());
+      return loaded;
+   }
+
+   // inserts (or replaces) value of 'key'
+   // returns false if it is too large to be cached (see max_entry_size)
+   bool put(const K& key, value_type value, std::size_t size = 1)
+   {
+      shard& s = shard_of(key);
+      std::lock_guard<std::mutex> lock{ s.mutex };
+      s.erase(key);
+      return s.insert(key, std::move(value), size, expiry());
+   }
+
+   std::size_t shard_count() const noexcept { return n_shards_; }
+
+   // largest entry size that is always cached
+   std::size_t max_entry_size() const noexcept { return shards_[n_shards_ - 1].capacity; }
+
+   bool erase(const K& key)
+   {
+      shard& s = shard_of(key);
+      std::lock_guard<std::mutex> lock{ s.mutex };
+      return s.erase(key);
+   }
+
+   void clear()
+   {
+      for (std::size_t i = 0; i < n_shards_; i++) {
+         std::lock_guard<std::mutex> lock{ shards_[i].mutex };
+         shards_[i].index.clear();
+         shards_[i].lru.clear();
+         shards_[i].used = 0;
+      }
+   }
+
+   lru_cache_stats stats() const
+   {
+      lru_cache_stats st{ 0, 0, 0, 0, 0, 0, 0 };
+      for (std::size_t i = 0; i < n_shards_; i++) {
+         const shard& s = shards_[i];
+         std::lock_guard<std::mutex> lock{ s.mutex };
+         st.hits += s.hits;
+         st.misses += s.misses;
+         st.evictions += s.evictions;
+         st.expirations += s.expirations;
+         st.rejections += s.rejections;
+         st.entries += s.index.size();
+         st.size += s.used;
+      }
+      return st;
+   }
+
+private:
+   struct entry
+   {
+      K key;
+      value_type value;
+      std::size_t size;
+      clock::time_point expires;
+   };
+
+   // most recently used entries first
+   using list_type = std::list<entry>;
+   using index_type = std::unordered_map<K, typename list_type::iterator, Hash, KeyEqual>;
+
+   struct shard
+   {
+      mutable std::mutex mutex;
+      list_type lru;
+      index_type index;
+      std::size_t capacity{ 0 };
+      std::size_t used{ 0 };
+      std::uint64_t hits{ 0 };
+      std::uint64_t misses{ 0 };
+      std::uint64_t evictions{ 0 };
+      std::uint64_t expirations{ 0 };
+      std::uint64_t rejections{ 0 };
+      // avoids false sharing between shard locks (64 bytes cache line)
+      char padding[64];
+
+      // live entry of 'key' (moved to front), or nullptr
+      entry* find(const K& key, clock::duration ttl)
+      {
+         auto it = index.find(key);
+         if (it == index.end())
+            return nullptr;
+         if (ttl != clock::duration::max() && clock::now() >= it->second->expires) {
+            expirations++;
+            remove(it);
+            return nullptr;
+         }
+         lru.splice(lru.begin(), lru, it->second);
+         return &*it->second;
+      }
+
+      bool insert(const K& key, value_type value, std::size_t size, clock::time_point expires)
+      {
+         // too large for this shard: not cached
+         if (size > capacity) {
+            rejections++;
+            return false;
+         }
+         while (used + size > capacity) {
+            evictions++;
+            remove(index.find(lru.back().key));
+         }
+         lru.push_front(entry{ key, std::move(value), size, expires });
+         index.emplace(key, lru.begin());
+         used += size;
+         return true;
+      }
+
+      bool erase(const K& key)
+      {
+         auto it = index.find(key);
+         if (it == index.end())
+            return false;
+         remove(it);
+         return true;
+      }
+
+      void remove(typename index_type::iterator it)
+      {
+         used -= it->second->size;
+         lru.erase(it->second);
+         index.erase(it);
+      }
+   };
+
+   const std::size_t n_shards_;
+   std::unique_ptr<shard[]> shards_;
+   const clock::duration ttl_;
+   Hash hash_;
+
+   // at most 'n_shards', but each one with min_shard_capacity (if possible)
+   static std::size_t shards_for(std::size_t capacity, std::size_t n_shards)
+   {
+      std::size_t max_shards = capacity / min_shard_capacity;
+      if (n_shards > max_shards)
+         n_shards = max_shards;
+      return n_shards > 0 ? n_shards : 1;
+   }
+
+   shard& shard_of(const K& key) const
+   {
+      // mixes hash bits, since std::hash may be the identity
+      std::uint64_t h = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull;
+      return shards_[(h >> 32) % n_shards_];
+   }
+
+   clock::time_point expiry() const
+   {
+      return ttl_ == clock::duration::max() ? clock::time_point::max() : clock::now() + ttl_;
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_LRU_CACHE_HPP
@@ -0,0 +1,111 @@
+#ifndef NNPTR_OPTIONAL_SREF_HPP
+#define NNPTR_OPTIONAL_SREF_HPP
+// ====================================================
+// Optional Not Null Shared Reference (nnptr::optional_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// optional_sref<T> is either empty or holds an sref<T> (such as the result
+// of sweak<T>::lock()). It takes no extra space beyond the handle itself:
+// empty state is just a null std::shared_ptr, that never escapes as an
+// sref (value() checks it, during Debug).
+// ========================================================================
+
+#include <exception>   // terminate
+#include <memory>      // shared_ptr
+#include <type_traits> // enable_if, is_convertible
+#include <utility>     // move
+
+namespace nnptr {
+
+template<typename T>
+class optional_sref
+{
+public:
+   // empty
+   optional_sref() noexcept = default;
+
+   optional_sref(std::nullptr_t) noexcept {}
+
+   optional_sref(const sref<T>& ref)
+     : data_{ ref.data_.get() }
+   {}
+
+   // empty if 'data' is null
+   explicit optional_sref(std::shared_ptr<T> data) noexcept
+     : data_{ std::move(data) }
+   {}
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   optional_sref(const optional_sref<Y>& other)
+     : data_{ other.data_ }
+   {}
+
+   bool has_value() const noexcept { return data_ != nullptr; }
+
+   explicit operator bool() const noexcept { return has_value(); }
+
+   sref<T> value() const&
+   {
+      check();
+      return sref<T>{ data_ };
+   }
+
+   // takes the reference out (leaving this empty)
+   sref<T> value() &&
+   {
+      check();
+      return sref<T>{ std::move(data_) };
+   }
+
+   sref<T> value_or(sref<T> other) const
+   {
+      if (!has_value())
+         return other;
+      return sref<T>{ data_ };
+   }
+
+   T* operator->() const
+   {
+      check();
+      return data_.get();
+   }
+
+   T& operator*() const
+   {
+      check();
+      return *data_;
+   }
+
+   void reset() noexcept { data_.reset(); }
+
+   // rebinds (optional_sref is not a reference, so it does not write through)
+   optional_sref& operator=(const sref<T>& ref)
+   {
+      data_ = ref.data_.get();
+      return *this;
+   }
+
+private:
+   template<class Y>
+   friend class optional_sref;
+
+   std::shared_ptr<T> data_;
+
+   void check() const
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (!data_)
+         std::terminate();
+#endif
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_OPTIONAL_SREF_HPP
@@ -0,0 +1,125 @@
+#ifndef NNPTR_RCU_SREF_HPP
+#define NNPTR_RCU_SREF_HPP
+// ====================================================
+// Read-Copy-Update Not Null Shared Reference (nnptr::rcu_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "epoch_domain.hpp" // epoch_domain, epoch_guard
+#include "sref.hpp"         // sref
+
+// ========================================================================
+// rcu_sref<T> holds the current version of some read-mostly state (such
+// as a lookup table that is reloaded while serving traffic).
+//
+// Readers take a snapshot: an epoch_guard plus a plain pointer to current
+// version, so no atomic read-modify-write is involved (and no lock).
+// Writers publish new versions with update(fn) (copy, modify and publish)
+// or store(), one at a time. Old versions are retired into an epoch_domain
+// and released by the writer as soon as all snapshots that could see them
+// are gone (versions still held by snapshots wait for the next update, or
+// for synchronize()).
+// ========================================================================
+
+#include <atomic>  // atomic
+#include <mutex>   // mutex, lock_guard
+#include <utility> // forward, move
+
+namespace nnptr {
+
+template<class T>
+class rcu_sref
+{
+public:
+   // read-side access to one version (valid while the snapshot exists)
+   // snapshots must not leave the thread that created them
+   class snapshot
+   {
+   public:
+      snapshot(snapshot&&) = default;
+
+      const T* operator->() const { return ptr_; }
+
+      const T& operator*() const { return *ptr_; }
+
+      const T& get() const { return *ptr_; }
+
+      operator const T&() const { return *ptr_; }
+
+   private:
+      friend class rcu_sref;
+
+      epoch_guard guard_;
+      const T* ptr_;
+
+      snapshot(epoch_domain& domain, const std::atomic<sref<T>*>& current)
+        : guard_{ domain }
+        , ptr_{ &current.load(std::memory_order_acquire)->get() }
+      {}
+   };
+
+   explicit rcu_sref(sref<T> initial, epoch_domain& domain = default_epoch_domain())
+     : domain_{ domain }
+     , current_{ new sref<T>{ std::move(initial) } }
+   {}
+
+   rcu_sref(const rcu_sref&) = delete;
+   rcu_sref& operator=(const rcu_sref&) = delete;
+
+   // no snapshots may exist here
+   ~rcu_sref() { delete current_.load(std::memory_order_acquire); }
+
+   snapshot read() const { return snapshot{ domain_, current_ }; }
+
+   // current version as a new reference (counted, may outlive this rcu_sref)
+   sref<T> load() const
+   {
+      epoch_guard guard{ domain_ };
+      return sref<T>{ *current_.load(std::memory_order_acquire) };
+   }
+
+   // publishes 'next' as current version
+   void store(sref<T> next)
+   {
+      std::lock_guard<std::mutex> lock{ writer_ };
+      publish(std::move(next));
+   }
+
+   // copies current version, modifies it with 'fn(T&)' and publishes it
+   // (writers are serialized, so no update is lost)
+   template<class F>
+   void update(F&& fn)
+   {
+      std::lock_guard<std::mutex> lock{ writer_ };
+      sref<T> next{ in_place, current_.load(std::memory_order_relaxed)->get() };
+      std::forward<F>(fn)(next.get());
+      publish(std::move(next));
+   }
+
+   // waits until old versions are no longer visible to any snapshot
+   // (cannot be called while holding a snapshot)
+   void synchronize() { domain_.synchronize(); }
+
+private:
+   epoch_domain& domain_;
+   std::atomic<sref<T>*> current_;
+   std::mutex writer_;
+
+   void publish(sref<T> next)
+   {
+      sref<T>* old = current_.exchange(new sref<T>{ std::move(next) }, std::memory_order_acq_rel);
+      domain_.retire(old);
+      // old versions may be large, so they are not left for the domain
+      // threshold: each collection advances the epoch at most once, and a
+      // version is freed two epochs after it was retired (if no snapshot
+      // holds the epoch back)
+      domain_.collect();
+      domain_.collect();
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_RCU_SREF_HPP
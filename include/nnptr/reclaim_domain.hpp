@@ -0,0 +1,221 @@
+#ifndef NNPTR_RECLAIM_DOMAIN_HPP
+#define NNPTR_RECLAIM_DOMAIN_HPP
+// ====================================================
+// Asynchronous Reclamation for Not Null Shared Reference (nnptr::reclaim_domain)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// reclaim_domain owns a small pool of background threads that run
+// destructors, so that dropping the last reference to a large object graph
+// never stalls a latency-critical thread.
+//
+// Objects created with domain.make_sref<T>() are enqueued (instead of
+// deleted) when their last reference is dropped. Handles and raw pointers
+// can also be given with retire(). When too many objects are pending,
+// releasing threads block until there is room (or destroy inline, see
+// reclaim_overflow). drain() waits for all pending work.
+//
+// Large graphs are destroyed in parallel when destructors retire their
+// children into the same domain (each child becomes a separate task).
+// Retire calls from the pool itself never block (they run inline when the
+// queue is full).
+//
+// Domain must outlive every sref created by its make_sref() (their deleter
+// refers to it), so keep such srefs from escaping its lifetime.
+// ========================================================================
+
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // uint64_t
+#include <deque>              // deque
+#include <memory>             // shared_ptr, unique_ptr
+#include <mutex>              // mutex, unique_lock
+#include <thread>             // thread
+#include <utility>            // forward, move
+#include <vector>             // vector
+
+namespace nnptr {
+
+// what a releasing thread does when the queue is full
+enum class reclaim_overflow
+{
+   block,     // waits for room (backpressure)
+   run_inline // destroys the object itself
+};
+
+// counters of a reclaim_domain
+struct reclaim_stats
+{
+   std::uint64_t enqueued;    // objects given to the pool
+   std::uint64_t destroyed;   // objects destroyed by the pool
+   std::uint64_t inlined;     // objects destroyed by releasing threads
+   std::uint64_t blocked;     // times a releasing thread waited for room
+   std::size_t pending;       // objects waiting right now
+   std::size_t max_pending;   // highest number of objects waiting
+};
+
+class reclaim_domain
+{
+public:
+   // 'capacity' is the maximum number of objects waiting
+   // (at least one thread and one object, otherwise nothing would progress)
+   explicit reclaim_domain(std::size_t n_threads = 1,
+                           std::size_t capacity = 4096,
+                           reclaim_overflow overflow = reclaim_overflow::block)
+     : capacity_{ capacity > 0 ? capacity : 1 }
+     , overflow_{ overflow }
+   {
+      if (n_threads == 0)
+         n_threads = 1;
+      for (std::size_t i = 0; i < n_threads; i++)
+         workers_.emplace_back([this]() { work(); });
+   }
+
+   reclaim_domain(const reclaim_domain&) = delete;
+   reclaim_domain& operator=(const reclaim_domain&) = delete;
+
+   // destroys everything still pending
+   ~reclaim_domain()
+   {
+      drain();
+      {
+         std::lock_guard<std::mutex> lock{ mutex_ };
+         stopping_ = true;
+      }
+      has_work_.notify_all();
+      for (auto& w : workers_)
+         w.join();
+   }
+
+   // frees 'ptr' with 'deleter' on the pool
+   void retire(void* ptr, void (*deleter)(void*))
+   {
+      {
+         std::unique_lock<std::mutex> lock{ mutex_ };
+         if (queue_.size() >= capacity_) {
+            if (overflow_ == reclaim_overflow::run_inline || is_worker()) {
+               inlined_++;
+               lock.unlock();
+               deleter(ptr);
+               return;
+            }
+            blocked_++;
+            has_room_.wait(lock, [this]() { return queue_.size() < capacity_; });
+         }
+         queue_.push_back(task{ ptr, deleter });
+         enqueued_++;
+         if (queue_.size() > max_pending_)
+            max_pending_ = queue_.size();
+      }
+      has_work_.notify_one();
+   }
+
+   template<class T>
+   void retire(T* ptr)
+   {
+      retire(static_cast<void*>(ptr), [](void* p) { delete static_cast<T*>(p); });
+   }
+
+   // drops reference 'ref' on the pool (destroys object if it was the last one)
+   template<class T>
+   void retire(sref<T> ref)
+   {
+      retire(new sref<T>{ std::move(ref) });
+   }
+
+   // drops each reference as a separate task (destroyed in parallel)
+   template<class InputIt>
+   void retire_batch(InputIt first, InputIt last)
+   {
+      for (; first != last; ++first)
+         retire(std::move(*first));
+   }
+
+   // creates a new 'sref' whose object is destroyed on the pool when the
+   // last reference is dropped
+   template<class T, class... Args>
+   sref<T> make_sref(Args&&... args)
+   {
+      std::unique_ptr<T> obj{ new T(std::forward<Args>(args)...) };
+      reclaim_domain* domain = this;
+      return sref<T>{ std::shared_ptr<T>(obj.release(), [domain](T* p) { domain->retire(p); }) };
+   }
+
+   // waits until all pending objects are destroyed (cannot be called from
+   // a destructor running on the pool)
+   void drain()
+   {
+      std::unique_lock<std::mutex> lock{ mutex_ };
+      drained_.wait(lock, [this]() { return queue_.empty() && running_ == 0; });
+   }
+
+   reclaim_stats stats() const
+   {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      return reclaim_stats{ enqueued_, destroyed_, inlined_, blocked_, queue_.size(), max_pending_ };
+   }
+
+private:
+   struct task
+   {
+      void* ptr;
+      void (*deleter)(void*);
+   };
+
+   const std::size_t capacity_;
+   const reclaim_overflow overflow_;
+   mutable std::mutex mutex_;
+   std::condition_variable has_work_;
+   std::condition_variable has_room_;
+   std::condition_variable drained_;
+   std::deque<task> queue_;
+   std::size_t running_{ 0 };
+   bool stopping_{ false };
+   std::uint64_t enqueued_{ 0 };
+   std::uint64_t destroyed_{ 0 };
+   std::uint64_t inlined_{ 0 };
+   std::uint64_t blocked_{ 0 };
+   std::size_t max_pending_{ 0 };
+   std::vector<std::thread> workers_;
+
+   // domain whose pool runs current thread (if any)
+   static reclaim_domain*& current() noexcept
+   {
+      static thread_local reclaim_domain* domain = nullptr;
+      return domain;
+   }
+
+   bool is_worker() const noexcept { return current() == this; }
+
+   void work()
+   {
+      current() = this;
+      std::unique_lock<std::mutex> lock{ mutex_ };
+      while (true) {
+         has_work_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+         if (queue_.empty())
+            return; // stopping
+         task t = queue_.front();
+         queue_.pop_front();
+         running_++;
+         lock.unlock();
+         has_room_.notify_one();
+         t.deleter(t.ptr);
+         lock.lock();
+         running_--;
+         destroyed_++;
+         if (queue_.empty() && running_ == 0)
+            drained_.notify_all();
+      }
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_RECLAIM_DOMAIN_HPP
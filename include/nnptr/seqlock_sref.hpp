@@ -0,0 +1,223 @@
+#ifndef NNPTR_SEQLOCK_SREF_HPP
+#define NNPTR_SEQLOCK_SREF_HPP
+// ====================================================
+// Seqlock Not Null Shared Reference (nnptr::seqlock_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, in_place
+
+// ========================================================================
+// seqlock_sref<T> shares a small trivially copyable value (such as a
+// counter, a bound or a best objective value) between threads, protected
+// by a sequence lock.
+//
+// Readers take optimistic snapshots with load(), that never write to
+// shared memory: they copy the value and retry if a writer was active.
+// Writers make the sequence number odd, write and make it even again
+// (writers exclude each other on the sequence number itself).
+//
+// Value is kept as relaxed atomic words, so concurrent copies are not
+// data races.
+// ========================================================================
+
+#include <atomic>      // atomic, atomic_thread_fence
+#include <cstddef>     // size_t
+#include <cstdint>     // uint8_t ... uint64_t
+#include <cstring>     // memcpy
+#include <thread>      // this_thread::yield
+#include <type_traits> // conditional, enable_if, is_trivially_copyable
+#include <utility>     // forward
+
+namespace nnptr {
+
+namespace details {
+
+// largest word that divides sizeof(T)
+template<class T>
+using seqlock_word_t = typename std::conditional<
+  sizeof(T) % 8 == 0,
+  std::uint64_t,
+  typename std::conditional<
+    sizeof(T) % 4 == 0,
+    std::uint32_t,
+    typename std::conditional<sizeof(T) % 2 == 0, std::uint16_t, std::uint8_t>::type>::type>::type;
+
+template<class T>
+struct seqlock_block
+{
+   using word_type = seqlock_word_t<T>;
+   static constexpr std::size_t n_words = sizeof(T) / sizeof(word_type);
+
+   // odd while a writer is active
+   std::atomic<unsigned> seq{ 0 };
+   std::atomic<word_type> words[n_words];
+
+   explicit seqlock_block(const T& value) noexcept { write(value); }
+
+   T read() const noexcept
+   {
+      word_type buffer[n_words];
+      while (true) {
+         unsigned s1 = seq.load(std::memory_order_acquire);
+         if (s1 & 1) {
+            std::this_thread::yield();
+            continue;
+         }
+         for (std::size_t i = 0; i < n_words; i++)
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_acquire);
+         if (seq.load(std::memory_order_relaxed) == s1)
+            break;
+      }
+      T value;
+      std::memcpy(&value, buffer, sizeof(T));
+      return value;
+   }
+
+   // copy taken by the writer (only called while locked)
+   T read_locked() const noexcept
+   {
+      word_type buffer[n_words];
+      for (std::size_t i = 0; i < n_words; i++)
+         buffer[i] = words[i].load(std::memory_order_relaxed);
+      T value;
+      std::memcpy(&value, buffer, sizeof(T));
+      return value;
+   }
+
+   // makes sequence odd (waits for other writers)
+   void lock() noexcept
+   {
+      unsigned s = seq.load(std::memory_order_relaxed);
+      while ((s & 1) || !seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+         if (s & 1) {
+            std::this_thread::yield();
+            s = seq.load(std::memory_order_relaxed);
+         }
+      }
+      // readers that see new words must also see odd sequence
+      std::atomic_thread_fence(std::memory_order_release);
+   }
+
+   void unlock() noexcept { seq.fetch_add(1, std::memory_order_release); }
+
+   // only called while locked (or during construction)
+   void write(const T& value) noexcept
+   {
+      word_type buffer[n_words];
+      std::memcpy(buffer, &value, sizeof(T));
+      for (std::size_t i = 0; i < n_words; i++)
+         words[i].store(buffer[i], std::memory_order_relaxed);
+   }
+};
+
+} // namespace details
+
+template<typename T>
+class seqlock_sref
+{
+   static_assert(std::is_trivially_copyable<T>::value, "seqlock_sref requires a trivially copyable type");
+   static_assert(std::is_default_constructible<T>::value, "seqlock_sref requires a default constructible type");
+
+   using block_type = details::seqlock_block<T>;
+
+public:
+   seqlock_sref(const T& value)
+     : block_{ in_place, value }
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit seqlock_sref(in_place_t, Args&&... args)
+     : block_{ in_place, T(std::forward<Args>(args)...) }
+   {}
+
+   // disallow explicit nullptr
+   seqlock_sref(std::nullptr_t data) = delete;
+
+   seqlock_sref(const seqlock_sref& other) = default;
+
+   // moved-from seqlock_sref can only be destroyed, or be assigned to (then
+   // it shares the other value)
+   seqlock_sref(seqlock_sref&& corpse) noexcept = default;
+
+   // consistent copy of current value (never writes to shared memory)
+   T load() const noexcept { return block_->read(); }
+
+   operator T() const noexcept { return load(); }
+
+   void store(const T& value) noexcept
+   {
+      block_type& block = block_.get();
+      block.lock();
+      block.write(value);
+      block.unlock();
+   }
+
+   // replaces value with 'fn(T&)' applied to current value, atomically
+   // (such as keeping the best objective value found so far), where
+   // 'fn' must not throw
+   template<class F>
+   void update(F&& fn)
+   {
+      block_type& block = block_.get();
+      block.lock();
+      T value = block.read_locked();
+      std::forward<F>(fn)(value);
+      block.write(value);
+      block.unlock();
+   }
+
+   long use_count() const noexcept { return block_.data_.get().use_count(); }
+
+   // assignment writes through (like a reference)
+   seqlock_sref& operator=(const seqlock_sref& other) noexcept
+   {
+      // moved-from: shares the other value
+      if (details::sref_access::moved_from(block_)) {
+         block_.data_ = other.block_.data_;
+         return *this;
+      }
+      store(other.load());
+      return *this;
+   }
+
+   // moved-from: takes the value of 'corpse' (otherwise writes through)
+   seqlock_sref& operator=(seqlock_sref&& corpse) noexcept
+   {
+      if (this == &corpse)
+         return *this;
+      if (details::sref_access::moved_from(block_)) {
+         block_.data_ = std::move(corpse.block_.data_);
+         return *this;
+      }
+      store(corpse.load());
+      return *this;
+   }
+
+   seqlock_sref& operator=(const T& value) noexcept
+   {
+      store(value);
+      return *this;
+   }
+
+private:
+   sref<block_type> block_;
+};
+
+// creates a new 'seqlock_sref' with a single allocation
+template<class T, class... Args>
+seqlock_sref<T>
+make_seqlock_sref(Args&&... args)
+{
+   return seqlock_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_SEQLOCK_SREF_HPP
@@ -0,0 +1,269 @@
+#ifndef NNPTR_SHARDED_SREF_HPP
+#define NNPTR_SHARDED_SREF_HPP
+// ====================================================
+// Sharded Not Null Shared Reference (nnptr::sharded_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, in_place
+
+// ========================================================================
+// sharded_sref<T, Slots> behaves as sref<T>, but reference count is split
+// into 'Slots' counters (each one on its own cache line). Every thread
+// always increments the same slot, so copies from different threads do
+// not compete for the same cache line.
+//
+// Each handle remembers the slot it was counted on, so slots never go
+// negative. A shared counter of non-empty slots (as a "scalable non-zero
+// indicator") is only touched when some slot becomes empty or non-empty,
+// and object dies when there are no more non-empty slots.
+//
+// Intended for few objects shared by all threads (each one has Slots * 64
+// bytes of counters), such as global problem instances and evaluators.
+// ========================================================================
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t
+#include <exception>   // terminate
+#include <memory>      // shared_ptr
+#include <type_traits> // enable_if, is_convertible
+#include <utility>     // forward, move
+
+namespace nnptr {
+
+namespace details {
+
+constexpr std::size_t cache_line_size = 64;
+
+// counter alone in its cache line
+struct padded_counter
+{
+   std::atomic<long> value{ 0 };
+   char padding[cache_line_size - sizeof(std::atomic<long>)];
+};
+
+template<class T, std::size_t Slots>
+struct sharded_block
+{
+   padded_counter slots[Slots];
+   // number of non-empty slots
+   padded_counter nonzero;
+   T value;
+
+   template<class... Args>
+   explicit sharded_block(Args&&... args)
+     : value(std::forward<Args>(args)...)
+   {}
+};
+
+// slot index of current thread (threads are numbered on first use)
+inline unsigned
+thread_slot_index() noexcept
+{
+   static std::atomic<unsigned> next{ 0 };
+   static thread_local unsigned index = next.fetch_add(1, std::memory_order_relaxed);
+   return index;
+}
+
+} // namespace details
+
+template<typename T, std::size_t Slots = 16>
+class sharded_sref
+{
+   static_assert(Slots > 0, "sharded_sref requires at least one slot");
+
+   using block_type = details::sharded_block<T, Slots>;
+
+public:
+   // this constructor can be used to "move" into new sharded_sref versions
+   // this requires a move constructor over the type T
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   sharded_sref(X&& other)
+     : sharded_sref(new block_type(std::move(other)))
+   {}
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   sharded_sref(const X& other)
+     : sharded_sref(new block_type(other))
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit sharded_sref(in_place_t, Args&&... args)
+     : sharded_sref(new block_type(std::forward<Args>(args)...))
+   {}
+
+   // disallow explicit nullptr
+   sharded_sref(std::nullptr_t data) = delete;
+
+   sharded_sref(const sharded_sref& other) noexcept
+     : block_{ other.get_block() }
+     , slot_{ current_slot() }
+   {
+      if (block_->slots[slot_].value.fetch_add(1, std::memory_order_relaxed) == 0)
+         block_->nonzero.value.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // takes ownership from 'corpse' (no reference counting involved)
+   // moved-from sharded_sref has no block: it can only be destroyed, or be
+   // assigned to (then it is counted on the other block, like a new copy)
+   sharded_sref(sharded_sref&& corpse) noexcept
+     : block_{ corpse.block_ }
+     , slot_{ corpse.slot_ }
+   {
+      corpse.block_ = nullptr;
+   }
+
+   ~sharded_sref()
+   {
+      if (block_ &&
+          block_->slots[slot_].value.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+          block_->nonzero.value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         delete block_;
+   }
+
+   T* operator->() { return &get_block()->value; }
+
+   const T* operator->() const { return &get_block()->value; }
+
+   T& operator*() { return get_block()->value; }
+
+   const T& operator*() const { return get_block()->value; }
+
+   T& get() { return get_block()->value; }
+
+   const T& get() const { return get_block()->value; }
+
+   operator T&() { return get_block()->value; }
+
+   // sums all slots (approximated when called during concurrent changes)
+   long use_count() const noexcept
+   {
+      long count = 0;
+      for (const auto& slot : get_block()->slots)
+         count += slot.value.load(std::memory_order_relaxed);
+      return count;
+   }
+
+   // shares ownership with a new sref<Y> (allocates a std::shared_ptr control block)
+   template<class Y = T, typename = typename std::enable_if<std::is_convertible<T*, Y*>::value>::type>
+   sref<Y> to_sref() const
+   {
+      sharded_sref keep{ *this };
+      Y* ptr = &keep.block_->value;
+      return std::shared_ptr<Y>(ptr, [keep](Y*) {});
+   }
+
+   sharded_sref& operator=(const sharded_sref& other)
+   {
+      // self-reference
+      if (this == &other)
+         return *this;
+
+      // moved-from: counts a new reference on current thread slot
+      if (!block_) {
+         block_ = other.get_block();
+         slot_ = current_slot();
+         if (block_->slots[slot_].value.fetch_add(1, std::memory_order_relaxed) == 0)
+            block_->nonzero.value.fetch_add(1, std::memory_order_relaxed);
+         return *this;
+      }
+
+      // ASSUME NON-NULL FOR operator=
+      get_block()->value = other.get_block()->value;
+
+      return *this;
+   }
+
+   // moved-from: takes the reference of 'corpse' (otherwise writes through,
+   // moving the value only if 'corpse' is its last reference)
+   sharded_sref& operator=(sharded_sref&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (!block_) {
+         block_ = corpse.block_;
+         slot_ = corpse.slot_;
+         corpse.block_ = nullptr;
+         return *this;
+      }
+
+      // value is only moved when no other sharded_sref can see it (slots
+      // are summed, so any other reference counts)
+      if (corpse.use_count() > 1)
+         get_block()->value = corpse.get_block()->value;
+      else
+         get_block()->value = std::move(corpse.get_block()->value);
+
+      return *this;
+   }
+
+   // assignment writes through (like a reference), so no new sharded_sref is created
+   sharded_sref& operator=(const T& value)
+   {
+      get_block()->value = value;
+      return *this;
+   }
+
+   sharded_sref& operator=(T&& value)
+   {
+      get_block()->value = std::move(value);
+      return *this;
+   }
+
+private:
+   block_type* block_;
+   // slot where this reference is counted
+   unsigned slot_;
+
+   // takes a new block (first reference)
+   explicit sharded_sref(block_type* block) noexcept
+     : block_{ block }
+     , slot_{ current_slot() }
+   {
+      block_->slots[slot_].value.store(1, std::memory_order_relaxed);
+      block_->nonzero.value.store(1, std::memory_order_relaxed);
+   }
+
+   static unsigned current_slot() noexcept
+   {
+      return details::thread_slot_index() % Slots;
+   }
+
+   block_type* get_block() const noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (block_ == nullptr)
+         std::terminate();
+#endif
+      return block_;
+   }
+};
+
+// creates a new 'sharded_sref' (counters and object in a single allocation)
+template<class T, std::size_t Slots = 16, class... Args>
+sharded_sref<T, Slots>
+make_sharded_sref(Args&&... args)
+{
+   return sharded_sref<T, Slots>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_SHARDED_SREF_HPP
@@ -20,7 +20,8 @@
 #define NO_NNPTR_CHECKS
 #endif
 
-#include <memory> // shared_ptr
+#include <memory>  // shared_ptr, make_shared
+#include <utility> // in_place (C++17)
 
 // =============
 // For nnptr::NotNull
@@ -52,6 +53,10 @@
 // - ensure construction from null U* fails
 // - allow implicit conversion to U*
 //
+// NotNull<T> can be moved when T can be moved (e.g., std::unique_ptr).
+// A moved-from NotNull may only be destroyed or assigned to (any access
+// breaks on Debug), so the non-null invariant holds for every usable object.
+//
 
 // ==============================================
 // code for NotNull (compatible with gsl::not_null)
@@ -74,6 +79,15 @@ struct is_comparable_to_nullptr<
   : std::true_type
 {
 };
+
+// returns T by value only when it is cheap to copy (raw pointers, small
+// trivially copyable handles); other types (such as std::shared_ptr) are
+// returned by const reference, so no reference count is touched on access
+template<typename T>
+using value_or_reference_return_t = std::conditional_t<
+  sizeof(T) <= 2 * sizeof(void*) && std::is_trivially_copy_constructible<T>::value,
+  const T,
+  const T&>;
 } // namespace details
 
 template<class T>
@@ -82,7 +96,9 @@ class NotNull
 public:
    static_assert(details::is_comparable_to_nullptr<T>::value, "T cannot be compared to nullptr.");
 
-   template<typename U, typename = std::enable_if_t<std::is_convertible<U, T>::value>>
+   template<typename U,
+            typename = std::enable_if_t<std::is_convertible<U, T>::value &&
+                                        !std::is_same<std::decay_t<U>, NotNull>::value>>
    constexpr NotNull(U&& u)
      : ptr_(std::forward<U>(u))
    {
@@ -107,9 +123,16 @@ public:
      : NotNull(other.get())
    {}
 
+   template<typename U, typename = std::enable_if_t<std::is_convertible<U, T>::value>>
+   constexpr NotNull(NotNull<U>&& other)
+     : NotNull(std::move(other.ptr_))
+   {}
+
    NotNull(const NotNull& other) = default;
+   NotNull(NotNull&& other) = default;
    NotNull& operator=(const NotNull& other) = default;
-   constexpr std::conditional_t<std::is_copy_constructible<T>::value, T, const T&> get() const
+   NotNull& operator=(NotNull&& other) = default;
+   constexpr details::value_or_reference_return_t<T> get() const
    {
 #ifndef NO_NNPTR_CHECKS
       if (ptr_ == nullptr)
@@ -136,6 +159,13 @@ public:
    void operator[](std::ptrdiff_t) const = delete;
 
 private:
+   template<class U>
+   friend class NotNull;
+
+   // sref checks for a moved-from state (to rebind it on assignment)
+   template<class U>
+   friend class sref;
+
    T ptr_;
 };
 
@@ -238,6 +268,26 @@ struct hash<nnptr::NotNull<T>>
 // ======================
 
 namespace nnptr {
+
+// tag for in-place construction of the shared object (std::in_place on C++17)
+#if __cplusplus >= 201703L
+using std::in_place;
+using std::in_place_t;
+#else
+struct in_place_t
+{
+   explicit in_place_t() = default;
+};
+constexpr in_place_t in_place{};
+#endif
+
+template<typename T>
+class sref_view;
+
+namespace details {
+struct sref_access;
+} // namespace details
+
 //
 template<typename T>
 class sref
@@ -248,15 +298,15 @@ public:
    NotNull<std::shared_ptr<T>> data_;
 
    // this constructor can be used to "move" into new shared_ptr versions
-   // this requires a copy constructor over the type X (must be concrete)
+   // this requires a move constructor over the type X (must be concrete)
    template<
      class X,
      typename =
        typename std::enable_if<std::is_convertible<X*, T*>::value>::type,
      typename =
-       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
    sref(X&& other)
-     : data_{ std::shared_ptr<T>{ new X(other) } }
+     : data_{ std::make_shared<X>(std::move(other)) }
    {}
 
    // this is for existing references (must have copy constructor)
@@ -267,21 +317,46 @@ public:
      typename =
        typename std::enable_if<std::is_copy_constructible<X>::value>::type>
    sref(const X& other)
-     : data_{ std::shared_ptr<T>{ new X(other) } }
+     : data_{ std::make_shared<X>(other) }
+   {}
+
+   // builds object and control block in a single allocation (see make_sref)
+   // this also works for non-copyable types (such as std::mutex)
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit sref(in_place_t, Args&&... args)
+     : data_{ std::make_shared<T>(std::forward<Args>(args)...) }
    {}
 
    sref(const sref<T>& other)
      : data_{ other.data_ }
    {}
 
-   sref(const sref<T>&& corpse)
-     : data_{ corpse.data_ }
+   // takes ownership from 'corpse' (no reference counting involved)
+   // moved-from sref can only be destroyed or assigned to (which rebinds it)
+   sref(sref<T>&& corpse) noexcept
+     : data_{ std::move(corpse.data_) }
    {}
 
-   sref(std::shared_ptr<T>& data)
+   sref(const std::shared_ptr<T>& data)
      : data_{ data }
    {}
 
+   sref(std::shared_ptr<T>&& data)
+     : data_{ std::move(data) }
+   {}
+
+   template<
+     class Y,
+     class D,
+     typename =
+       typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   sref(std::unique_ptr<Y, D>&& data)
+     : data_{ std::shared_ptr<T>{ std::move(data) } }
+   {}
+
    sref(T* data)
      : data_{ std::shared_ptr<T>{ data } }
    {}
@@ -289,6 +364,16 @@ public:
    // disallow explicit nullptr
    sref(std::nullptr_t data) = delete;
 
+   // sref to an object that outlives every sref (static storage, singletons)
+   // it has no control block, so copies and destruction never touch any
+   // reference counter (std::shared_ptr already skips them when it is empty)
+   static sref<T> immortal(T& obj) noexcept
+   {
+      return sref<T>{ std::shared_ptr<T>{ std::shared_ptr<T>{}, &obj } };
+   }
+
+   static sref<T> immortal(T&& obj) = delete;
+
    T* operator->() { return data_.get().get(); }
 
    const T* operator->() const { return data_.get().get(); }
@@ -317,6 +402,11 @@ public:
       return *data_;
    }
 
+   // non-owning view, for hot function parameters (see sref_view)
+   sref_view<T> borrow() { return sref_view<T>{ *this }; }
+
+   sref_view<const T> borrow() const { return sref_view<const T>{ *this }; }
+
    // method 'sptr' should be taken only in extreme/compatibility cases
    std::shared_ptr<T> sptr() const
    {
@@ -329,12 +419,52 @@ public:
       if (this == &other)
          return *this;
 
+      // moved-from sref takes the other object (like a new sref)
+      if (moved_from()) {
+         data_ = other.data_;
+         return *this;
+      }
+
       // ASSUME NON-NULL FOR operator=
       (*this->data_) = (*other.data_);
 
       return *this;
    }
 
+   // writes through as well, but a moved-from sref takes ownership from
+   // 'corpse' (so std::swap and vector::insert move handles around)
+   sref<T>& operator=(sref<T>&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (moved_from()) {
+         data_ = std::move(corpse.data_);
+         return *this;
+      }
+
+      // value is only moved when no other sref can see it
+      if (corpse.data_.get().use_count() > 1)
+         (*this->data_) = (*corpse.data_);
+      else
+         (*this->data_) = std::move(*corpse.data_);
+
+      return *this;
+   }
+
+   // assignment writes through (like a reference), so no new sref is created
+   sref<T>& operator=(const T& value)
+   {
+      (*this->data_) = value;
+      return *this;
+   }
+
+   sref<T>& operator=(T&& value)
+   {
+      (*this->data_) = std::move(value);
+      return *this;
+   }
+
    operator T&()
    {
       // return dereferenced shared object
@@ -347,8 +477,115 @@ public:
       std::shared_ptr<Y> py = data_.get(); // remove encapsulation from 'NotNull'
       return py;
    }
+
+private:
+   friend struct details::sref_access;
+
+   bool moved_from() const noexcept { return data_.ptr_ == nullptr; }
+};
+
+namespace details {
+
+// lets handles built on sref (such as synchronized_sref) check whether it
+// was moved from, so that assignment can rebind instead of writing through
+struct sref_access
+{
+   template<class T>
+   static bool moved_from(const sref<T>& ref) noexcept
+   {
+      return ref.moved_from();
+   }
+};
+
+} // namespace details
+
+// ===========================
+// begin nnptr::sref_view part
+// ===========================
+
+// sref_view<T> is a non-null, non-owning view of an object owned elsewhere
+// (by an sref, uref or a plain reference). It is trivially copyable and has
+// the size of a pointer, so passing it by value involves no reference
+// counting (unlike sref<T>) and no double indirection (unlike const sref&).
+//
+// Like a string_view, it must not outlive its owners. Define NNPTR_DEBUG_VIEW
+// to keep a weak reference to the sref it came from, so that any access
+// after all owning srefs are gone breaks (views are then larger).
+// Copies and assignments rebind the view (it does not write through).
+template<typename T>
+class sref_view
+{
+public:
+   sref_view(T& ref) noexcept
+     : ptr_{ &ref }
+   {}
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   sref_view(sref<Y>& ref) noexcept
+     : ptr_{ ref.data_.get().get() }
+#ifdef NNPTR_DEBUG_VIEW
+     , owner_{ ref.data_.get() }
+     , owned_{ ref.data_.get().use_count() != 0 } // immortal is never checked
+#endif
+   {}
+
+   // views of const srefs must be const (like sref<T>::get() const)
+   template<class Y, typename = typename std::enable_if<std::is_convertible<const Y*, T*>::value>::type>
+   sref_view(const sref<Y>& ref) noexcept
+     : ptr_{ ref.data_.get().get() }
+#ifdef NNPTR_DEBUG_VIEW
+     , owner_{ ref.data_.get() }
+     , owned_{ ref.data_.get().use_count() != 0 }
+#endif
+   {}
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   sref_view(const sref_view<Y>& other) noexcept
+     : ptr_{ other.ptr_ }
+#ifdef NNPTR_DEBUG_VIEW
+     , owner_{ other.owner_ }
+     , owned_{ other.owned_ }
+#endif
+   {}
+
+   // disallow explicit nullptr
+   sref_view(std::nullptr_t data) = delete;
+
+   T* operator->() const { return &get(); }
+
+   T& operator*() const { return get(); }
+
+   T& get() const
+   {
+#ifdef NNPTR_DEBUG_VIEW
+      // view outlived every owning sref
+      if (owned_ && owner_.expired())
+         std::terminate();
+#endif
+      return *ptr_;
+   }
+
+   operator T&() const { return get(); }
+
+private:
+   template<class Y>
+   friend class sref_view;
+
+   T* ptr_;
+#ifdef NNPTR_DEBUG_VIEW
+   std::weak_ptr<const void> owner_;
+   bool owned_{ false };
+#endif
 };
 
+// creates a new 'sref' with a single allocation (similar to std::make_shared)
+template<class T, class... Args>
+sref<T>
+make_sref(Args&&... args)
+{
+   return sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
 } // namespace nn
 
 #endif // NNPTR_sref_HPP
@@ -0,0 +1,371 @@
+#ifndef NNPTR_SREF_CHANNEL_HPP
+#define NNPTR_SREF_CHANNEL_HPP
+// ====================================================
+// Channels of Not Null Shared References (nnptr::spsc_channel, nnptr::mpmc_channel)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// Bounded lock-free channels that move sref<T> handles between threads
+// (such as jobs between pipeline stages). Handles are moved into and out
+// of the ring, so reference count is never touched on the way (and its
+// cache line never travels between cores).
+//
+// - spsc_channel<T>: single producer and single consumer (ring buffer)
+// - mpmc_channel<T>: many producers and many consumers (bounded queue of
+//   Dmitry Vyukov, with a sequence number per cell)
+//
+// try_push/try_pop never block. push/pop spin (and then yield) while the
+// channel is full/empty. Batch versions move as many handles as possible.
+// try_push only moves from its argument when it succeeds. Handles moved
+// by batch pushes are left moved-from: destroy them, or assign another
+// sref to them (assignment rebinds a moved-from sref). Pops write into
+// output iterators that construct (such as std::back_inserter), since
+// sref assignment writes through.
+// Capacity is rounded up to a power of two.
+// ========================================================================
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t
+#include <memory>      // unique_ptr
+#include <new>         // placement new
+#include <thread>      // this_thread::yield
+#include <type_traits> // aligned_storage
+#include <utility>     // move
+
+namespace nnptr {
+
+namespace details {
+
+inline std::size_t
+channel_capacity(std::size_t capacity) noexcept
+{
+   std::size_t c = 2;
+   while (c < capacity)
+      c *= 2;
+   return c;
+}
+
+// raw storage for one sref (constructed only while holding a handle)
+template<class T>
+struct channel_slot
+{
+   typename std::aligned_storage<sizeof(sref<T>), alignof(sref<T>)>::type storage;
+
+   void put(sref<T>&& ref) noexcept { new (&storage) sref<T>(std::move(ref)); }
+
+   sref<T> take() noexcept
+   {
+      sref<T>* p = reinterpret_cast<sref<T>*>(&storage);
+      sref<T> ref{ std::move(*p) };
+      p->~sref<T>();
+      return ref;
+   }
+};
+
+// spins for a while and then yields the processor
+class channel_backoff
+{
+public:
+   void wait() noexcept
+   {
+      if (spins_ < 64)
+         spins_++;
+      else
+         std::this_thread::yield();
+   }
+
+private:
+   int spins_{ 0 };
+};
+
+} // namespace details
+
+template<class T>
+class spsc_channel
+{
+public:
+   explicit spsc_channel(std::size_t capacity)
+     : mask_{ details::channel_capacity(capacity) - 1 }
+     , slots_{ new details::channel_slot<T>[mask_ + 1] }
+   {}
+
+   spsc_channel(const spsc_channel&) = delete;
+   spsc_channel& operator=(const spsc_channel&) = delete;
+
+   // remaining handles are dropped
+   ~spsc_channel()
+   {
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      for (std::size_t h = head_.load(std::memory_order_relaxed); h != tail; h++)
+         slots_[h & mask_].take();
+   }
+
+   std::size_t capacity() const noexcept { return mask_ + 1; }
+
+   // producer side
+
+   bool try_push(sref<T>&& ref) noexcept
+   {
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail - head_cache_ > mask_) {
+         head_cache_ = head_.load(std::memory_order_acquire);
+         if (tail - head_cache_ > mask_)
+            return false;
+      }
+      slots_[tail & mask_].put(std::move(ref));
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   void push(sref<T>&& ref) noexcept
+   {
+      details::channel_backoff backoff;
+      while (!try_push(std::move(ref)))
+         backoff.wait();
+   }
+
+   // moves from [first, last) while there is room (returns first not moved)
+   template<class InputIt>
+   InputIt try_push_batch(InputIt first, InputIt last) noexcept
+   {
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      head_cache_ = head_.load(std::memory_order_acquire);
+      std::size_t t = tail;
+      for (; first != last && t - head_cache_ <= mask_; ++first, ++t)
+         slots_[t & mask_].put(std::move(*first));
+      tail_.store(t, std::memory_order_release);
+      return first;
+   }
+
+   template<class InputIt>
+   void push_batch(InputIt first, InputIt last) noexcept
+   {
+      details::channel_backoff backoff;
+      while ((first = try_push_batch(first, last)) != last)
+         backoff.wait();
+   }
+
+   // consumer side
+
+   // moves one handle into '*out' (such as a std::back_inserter)
+   template<class OutputIt>
+   bool try_pop(OutputIt out)
+   {
+      return try_pop_batch(out, 1) == 1;
+   }
+
+   sref<T> pop()
+   {
+      details::channel_backoff backoff;
+      while (true) {
+         std::size_t head = head_.load(std::memory_order_relaxed);
+         if (head != tail_cache_ || head != (tail_cache_ = tail_.load(std::memory_order_acquire))) {
+            sref<T> ref = slots_[head & mask_].take();
+            head_.store(head + 1, std::memory_order_release);
+            return ref;
+         }
+         backoff.wait();
+      }
+   }
+
+   // moves up to 'max' handles into 'out' (returns how many)
+   template<class OutputIt>
+   std::size_t try_pop_batch(OutputIt out, std::size_t max)
+   {
+      std::size_t head = head_.load(std::memory_order_relaxed);
+      if (tail_cache_ - head < max)
+         tail_cache_ = tail_.load(std::memory_order_acquire);
+      std::size_t n = tail_cache_ - head;
+      if (n > max)
+         n = max;
+      // slot is released before 'out' runs any user code
+      for (std::size_t i = 0; i < n; i++) {
+         sref<T> ref = slots_[(head + i) & mask_].take();
+         head_.store(head + i + 1, std::memory_order_release);
+         *out++ = std::move(ref);
+      }
+      return n;
+   }
+
+   // waits for at least one handle (returns how many)
+   template<class OutputIt>
+   std::size_t pop_batch(OutputIt out, std::size_t max)
+   {
+      details::channel_backoff backoff;
+      std::size_t n;
+      while ((n = try_pop_batch(out, max)) == 0 && max > 0)
+         backoff.wait();
+      return n;
+   }
+
+private:
+   const std::size_t mask_;
+   std::unique_ptr<details::channel_slot<T>[]> slots_;
+   // producer and consumer data on separate cache lines (64 bytes)
+   char pad0_[64];
+   std::atomic<std::size_t> tail_{ 0 };
+   std::size_t head_cache_{ 0 }; // producer view of head_
+   char pad1_[64];
+   std::atomic<std::size_t> head_{ 0 };
+   std::size_t tail_cache_{ 0 }; // consumer view of tail_
+   char pad2_[64];
+};
+
+template<class T>
+class mpmc_channel
+{
+public:
+   explicit mpmc_channel(std::size_t capacity)
+     : mask_{ details::channel_capacity(capacity) - 1 }
+     , cells_{ new cell[mask_ + 1] }
+   {
+      for (std::size_t i = 0; i <= mask_; i++)
+         cells_[i].seq.store(i, std::memory_order_relaxed);
+   }
+
+   mpmc_channel(const mpmc_channel&) = delete;
+   mpmc_channel& operator=(const mpmc_channel&) = delete;
+
+   // remaining handles are dropped
+   ~mpmc_channel()
+   {
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      for (std::size_t h = head_.load(std::memory_order_relaxed); h != tail; h++)
+         cells_[h & mask_].slot.take();
+   }
+
+   std::size_t capacity() const noexcept { return mask_ + 1; }
+
+   bool try_push(sref<T>&& ref) noexcept
+   {
+      std::size_t pos = tail_.load(std::memory_order_relaxed);
+      while (true) {
+         cell& c = cells_[pos & mask_];
+         std::size_t seq = c.seq.load(std::memory_order_acquire);
+         std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+         if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+               c.slot.put(std::move(ref));
+               c.seq.store(pos + 1, std::memory_order_release);
+               return true;
+            }
+         } else if (diff < 0)
+            return false; // full
+         else
+            pos = tail_.load(std::memory_order_relaxed);
+      }
+   }
+
+   void push(sref<T>&& ref) noexcept
+   {
+      details::channel_backoff backoff;
+      while (!try_push(std::move(ref)))
+         backoff.wait();
+   }
+
+   // moves from [first, last) while there is room (returns first not moved)
+   template<class InputIt>
+   InputIt try_push_batch(InputIt first, InputIt last) noexcept
+   {
+      for (; first != last; ++first)
+         if (!try_push(std::move(*first)))
+            break;
+      return first;
+   }
+
+   template<class InputIt>
+   void push_batch(InputIt first, InputIt last) noexcept
+   {
+      details::channel_backoff backoff;
+      while ((first = try_push_batch(first, last)) != last)
+         backoff.wait();
+   }
+
+   // moves one handle into '*out' (such as a std::back_inserter)
+   template<class OutputIt>
+   bool try_pop(OutputIt out)
+   {
+      std::size_t pos = head_.load(std::memory_order_relaxed);
+      while (true) {
+         cell& c = cells_[pos & mask_];
+         std::size_t seq = c.seq.load(std::memory_order_acquire);
+         std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+         if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+               sref<T> ref = c.slot.take();
+               c.seq.store(pos + mask_ + 1, std::memory_order_release);
+               *out = std::move(ref);
+               return true;
+            }
+         } else if (diff < 0)
+            return false; // empty
+         else
+            pos = head_.load(std::memory_order_relaxed);
+      }
+   }
+
+   sref<T> pop()
+   {
+      details::channel_backoff backoff;
+      while (true) {
+         std::size_t pos = head_.load(std::memory_order_relaxed);
+         cell& c = cells_[pos & mask_];
+         std::size_t seq = c.seq.load(std::memory_order_acquire);
+         if (seq == pos + 1 && head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            sref<T> ref = c.slot.take();
+            c.seq.store(pos + mask_ + 1, std::memory_order_release);
+            return ref;
+         }
+         if (static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0)
+            backoff.wait();
+      }
+   }
+
+   // moves up to 'max' handles into 'out' (returns how many)
+   template<class OutputIt>
+   std::size_t try_pop_batch(OutputIt out, std::size_t max)
+   {
+      std::size_t n = 0;
+      while (n < max && try_pop(out)) {
+         ++out;
+         n++;
+      }
+      return n;
+   }
+
+   // waits for at least one handle (returns how many)
+   template<class OutputIt>
+   std::size_t pop_batch(OutputIt out, std::size_t max)
+   {
+      details::channel_backoff backoff;
+      std::size_t n;
+      while ((n = try_pop_batch(out, max)) == 0 && max > 0)
+         backoff.wait();
+      return n;
+   }
+
+private:
+   struct cell
+   {
+      std::atomic<std::size_t> seq;
+      details::channel_slot<T> slot;
+   };
+
+   const std::size_t mask_;
+   std::unique_ptr<cell[]> cells_;
+   // producers and consumers on separate cache lines (64 bytes)
+   char pad0_[64];
+   std::atomic<std::size_t> tail_{ 0 };
+   char pad1_[64];
+   std::atomic<std::size_t> head_{ 0 };
+   char pad2_[64];
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_SREF_CHANNEL_HPP
@@ -0,0 +1,209 @@
+#ifndef NNPTR_SREF_FACTORY_CACHE_HPP
+#define NNPTR_SREF_FACTORY_CACHE_HPP
+// ====================================================
+// Weak-Value Factory Cache of Not Null Shared References (nnptr::sref_factory_cache)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "optional_sref.hpp" // optional_sref
+#include "sref.hpp"          // sref
+#include "sweak.hpp"         // sweak
+
+// ========================================================================
+// sref_factory_cache<K, V> memoizes immutable objects built from the same
+// parameters (key). It only keeps weak references: while a value is alive
+// anywhere, lookups for its key return the same sref<const V>; when it
+// dies, next lookup builds it again (dead entries are pruned as the cache
+// grows, or by prune()).
+//
+// Construction of each key happens only once at a time: concurrent lookups
+// of a key under construction wait for it (outside the shard lock). If the
+// builder fails (throws), a waiting lookup builds it again.
+// ========================================================================
+
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // uint64_t
+#include <functional>         // hash, equal_to
+#include <memory>             // shared_ptr, unique_ptr
+#include <mutex>              // mutex, lock_guard, unique_lock
+#include <unordered_map>      // unordered_map
+#include <utility>            // forward, move
+
+namespace nnptr {
+
+// counters of an sref_factory_cache (summed over all shards)
+struct sref_factory_cache_stats
+{
+   std::uint64_t hits;   // value was alive
+   std::uint64_t builds; // value was built
+   std::uint64_t waits;  // value was being built by another thread
+   std::size_t entries;  // entries kept (including dead ones not pruned yet)
+};
+
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class sref_factory_cache
+{
+public:
+   using value_type = sref<const V>;
+
+   explicit sref_factory_cache(std::size_t n_shards = 16)
+     : n_shards_{ n_shards > 0 ? n_shards : 1 }
+     , shards_{ new shard[n_shards_] }
+   {}
+
+   sref_factory_cache(const sref_factory_cache&) = delete;
+   sref_factory_cache& operator=(const sref_factory_cache&) = delete;
+
+   // value of 'key' if it is alive anywhere, or a new one given by 'build()'
+   // (which returns an sref<const V>, or something convertible)
+   template<class F>
+   value_type get(const K& key, F&& build)
+   {
+      shard& s = shard_of(key);
+      while (true) {
+         std::shared_ptr<construction> pending;
+         bool builder = false;
+         {
+            std::lock_guard<std::mutex> lock{ s.mutex };
+            entry& e = s.index[key];
+            optional_sref<const V> alive = e.value.lock();
+            if (alive) {
+               s.hits++;
+               return std::move(alive).value();
+            }
+            if (!e.pending) {
+               e.pending = std::make_shared<construction>();
+               builder = true;
+               s.builds++;
+               s.maybe_prune();
+            } else
+               s.waits++;
+            pending = e.pending;
+         }
+         if (builder) {
+            finisher done{ s, key, pending, nullptr };
+            value_type value{ std::forward<F>(build)() };
+            done.value = value;
+            return value;
+         }
+         std::unique_lock<std::mutex> lock{ pending->mutex };
+         pending->finished.wait(lock, [&pending]() { return pending->done; });
+         if (pending->value)
+            return pending->value.value();
+         // builder failed: try again
+      }
+   }
+
+   // removes entries whose values are dead
+   void prune()
+   {
+      for (std::size_t i = 0; i < n_shards_; i++) {
+         std::lock_guard<std::mutex> lock{ shards_[i].mutex };
+         shards_[i].prune();
+      }
+   }
+
+   sref_factory_cache_stats stats() const
+   {
+      sref_factory_cache_stats st{ 0, 0, 0, 0 };
+      for (std::size_t i = 0; i < n_shards_; i++) {
+         const shard& s = shards_[i];
+         std::lock_guard<std::mutex> lock{ s.mutex };
+         st.hits += s.hits;
+         st.builds += s.builds;
+         st.waits += s.waits;
+         st.entries += s.index.size();
+      }
+      return st;
+   }
+
+private:
+   // one construction in progress (waiters block on it, not on the shard)
+   struct construction
+   {
+      std::mutex mutex;
+      std::condition_variable finished;
+      bool done{ false };
+      optional_sref<const V> value; // empty if builder failed
+   };
+
+   struct entry
+   {
+      sweak<const V> value;
+      std::shared_ptr<construction> pending;
+   };
+
+   struct shard
+   {
+      mutable std::mutex mutex;
+      std::unordered_map<K, entry, Hash, KeyEqual> index;
+      std::size_t next_prune{ 16 };
+      std::uint64_t hits{ 0 };
+      std::uint64_t builds{ 0 };
+      std::uint64_t waits{ 0 };
+      // avoids false sharing between shard locks (64 bytes cache line)
+      char padding[64];
+
+      void prune()
+      {
+         for (auto it = index.begin(); it != index.end();)
+            if (!it->second.pending && it->second.value.expired())
+               it = index.erase(it);
+            else
+               ++it;
+      }
+
+      // prunes when the number of entries doubles (amortized constant time)
+      void maybe_prune()
+      {
+         if (index.size() < next_prune)
+            return;
+         prune();
+         next_prune = 2 * index.size() > 16 ? 2 * index.size() : 16;
+      }
+   };
+
+   // publishes result of a construction (also when builder throws)
+   struct finisher
+   {
+      shard& s;
+      const K& key;
+      std::shared_ptr<construction>& pending;
+      optional_sref<const V> value;
+
+      ~finisher()
+      {
+         {
+            std::lock_guard<std::mutex> lock{ s.mutex };
+            entry& e = s.index[key];
+            if (value)
+               e.value = value.value();
+            e.pending = nullptr;
+         }
+         {
+            std::lock_guard<std::mutex> lock{ pending->mutex };
+            pending->done = true;
+            pending->value = std::move(value);
+         }
+         pending->finished.notify_all();
+      }
+   };
+
+   const std::size_t n_shards_;
+   std::unique_ptr<shard[]> shards_;
+   Hash hash_;
+
+   shard& shard_of(const K& key) const
+   {
+      // mixes hash bits, since std::hash may be the identity
+      std::uint64_t h = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull;
+      return shards_[(h >> 32) % n_shards_];
+   }
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_SREF_FACTORY_CACHE_HPP
@@ -0,0 +1,107 @@
+#ifndef NNPTR_SWEAK_HPP
+#define NNPTR_SWEAK_HPP
+// ====================================================
+// Weak Reference for Not Null Shared Reference (nnptr::sweak)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "optional_sref.hpp" // optional_sref
+#include "sref.hpp"          // sref
+
+// ========================================================================
+// sweak<T> observes an object owned by sref<T> without keeping it alive
+// (such as a Person pointing back to its Company, breaking the cycle).
+// It sits on the same control block of sref (a std::weak_ptr), so
+// observers never keep dead objects in memory.
+//
+// lock() gives an optional_sref<T>, that is empty when object is gone.
+// A default sweak observes nothing (it is always expired).
+//
+// Immortal srefs (see sref<T>::immortal) have no control block, so their
+// sweak observes a static anchor instead, that never expires (and locking
+// it gives a counted sref, on that anchor).
+// ========================================================================
+
+#include <memory>      // shared_ptr, weak_ptr, make_shared
+#include <type_traits> // enable_if, is_convertible
+
+namespace nnptr {
+
+namespace details {
+
+// control block that is never released (observed by sweak of immortals)
+inline const std::shared_ptr<void>&
+immortal_anchor()
+{
+   static const std::shared_ptr<void>* anchor = new std::shared_ptr<void>{ std::make_shared<char>() };
+   return *anchor;
+}
+
+// owner that can be observed by a std::weak_ptr (anchored, if immortal)
+template<class T>
+std::shared_ptr<T>
+observable(const std::shared_ptr<T>& data)
+{
+   if (data.use_count() != 0)
+      return data;
+   return std::shared_ptr<T>{ immortal_anchor(), data.get() };
+}
+
+} // namespace details
+
+template<typename T>
+class sweak
+{
+public:
+   sweak() noexcept = default;
+
+   sweak(const sref<T>& ref)
+     : data_{ details::observable(ref.data_.get()) }
+   {}
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   sweak(const sref<Y>& ref)
+     : data_{ details::observable(ref.data_.get()) }
+   {}
+
+   template<class Y, typename = typename std::enable_if<std::is_convertible<Y*, T*>::value>::type>
+   sweak(const sweak<Y>& other) noexcept
+     : data_{ other.data_ }
+   {}
+
+   // shared reference to object, if it is still alive
+   optional_sref<T> lock() const noexcept { return optional_sref<T>{ data_.lock() }; }
+
+   bool expired() const noexcept { return data_.expired(); }
+
+   // number of sref (and std::shared_ptr) owning the object
+   long use_count() const noexcept { return data_.use_count(); }
+
+   void reset() noexcept { data_.reset(); }
+
+   // rebinds (a weak reference is not a reference to the object itself)
+   sweak& operator=(const sref<T>& ref)
+   {
+      data_ = details::observable(ref.data_.get());
+      return *this;
+   }
+
+   // ordering by control block (for use as key in associative containers)
+   template<class Y>
+   bool owner_before(const sweak<Y>& other) const noexcept
+   {
+      return data_.owner_before(other.data_);
+   }
+
+private:
+   template<class Y>
+   friend class sweak;
+
+   std::weak_ptr<T> data_;
+};
+
+} // namespace nnptr
+
+#endif // NNPTR_SWEAK_HPP
@@ -0,0 +1,248 @@
+#ifndef NNPTR_SYNCHRONIZED_SREF_HPP
+#define NNPTR_SYNCHRONIZED_SREF_HPP
+// ====================================================
+// Synchronized Not Null Shared Reference (nnptr::synchronized_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, in_place
+
+// ========================================================================
+// synchronized_sref<T, Mutex> shares ownership of an object together with
+// a lock (reader-writer lock by default), so that writes through any
+// sharer never race with reads from other threads.
+//
+// Lock and object live in the same allocation (with the control block).
+// Access is only given while holding the lock: with_read(fn) and
+// with_write(fn), or the read()/write() proxies that keep the lock until
+// they are destroyed. Mutex types without lock_shared() (such as
+// std::mutex) are locked exclusively for reading too.
+// ========================================================================
+
+#include <mutex>        // unique_lock
+#include <shared_mutex> // shared_mutex (C++17), shared_timed_mutex, shared_lock
+#include <type_traits>  // conditional, enable_if, is_same
+#include <utility>      // declval, forward, move
+
+namespace nnptr {
+
+namespace details {
+
+#if __cplusplus >= 201703L
+using default_shared_mutex = std::shared_mutex;
+#else
+using default_shared_mutex = std::shared_timed_mutex;
+#endif
+
+template<class M, class = void>
+struct has_lock_shared : std::false_type
+{};
+
+template<class M>
+struct has_lock_shared<M, decltype(std::declval<M&>().lock_shared())> : std::true_type
+{};
+
+// lock taken for reading
+template<class M>
+using read_lock_t = typename std::conditional<has_lock_shared<M>::value, std::shared_lock<M>, std::unique_lock<M>>::type;
+
+template<class T, class Mutex>
+struct synchronized_block
+{
+   // locked for reading from const handles
+   mutable Mutex mutex;
+   T value;
+
+   template<class... Args>
+   explicit synchronized_block(in_place_t, Args&&... args)
+     : value(std::forward<Args>(args)...)
+   {}
+};
+
+} // namespace details
+
+template<class T, class Mutex = details::default_shared_mutex>
+class synchronized_sref
+{
+   using block_type = details::synchronized_block<T, Mutex>;
+   using read_lock = details::read_lock_t<Mutex>;
+   using write_lock = std::unique_lock<Mutex>;
+
+public:
+   // holds a read lock while it exists
+   class read_proxy
+   {
+   public:
+      read_proxy(read_proxy&&) = default;
+
+      const T* operator->() const { return value_; }
+
+      const T& operator*() const { return *value_; }
+
+   private:
+      friend class synchronized_sref;
+
+      read_lock lock_;
+      const T* value_;
+
+      explicit read_proxy(const block_type& block)
+        : lock_{ block.mutex }
+        , value_{ &block.value }
+      {}
+   };
+
+   // holds a write lock while it exists
+   class write_proxy
+   {
+   public:
+      write_proxy(write_proxy&&) = default;
+
+      T* operator->() const { return value_; }
+
+      T& operator*() const { return *value_; }
+
+   private:
+      friend class synchronized_sref;
+
+      write_lock lock_;
+      T* value_;
+
+      explicit write_proxy(block_type& block)
+        : lock_{ block.mutex }
+        , value_{ &block.value }
+      {}
+   };
+
+   // this constructor can be used to "move" into new synchronized_sref versions
+   // this requires a move constructor over the type T
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   synchronized_sref(X&& other)
+     : block_{ in_place, in_place, std::move(other) }
+   {}
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   synchronized_sref(const X& other)
+     : block_{ in_place, in_place, other }
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit synchronized_sref(in_place_t, Args&&... args)
+     : block_{ in_place, in_place, std::forward<Args>(args)... }
+   {}
+
+   // disallow explicit nullptr
+   synchronized_sref(std::nullptr_t data) = delete;
+
+   synchronized_sref(const synchronized_sref& other) = default;
+
+   // moved-from synchronized_sref has no value nor lock left: it can only
+   // be destroyed, or be assigned to (then it shares the other block)
+   synchronized_sref(synchronized_sref&& corpse) noexcept = default;
+
+   // calls 'fn(const T&)' holding a read lock (returns its result)
+   template<class F>
+   decltype(auto) with_read(F&& fn) const
+   {
+      read_lock lock{ block_->mutex };
+      return std::forward<F>(fn)(static_cast<const T&>(block_->value));
+   }
+
+   // calls 'fn(T&)' holding a write lock (returns its result)
+   template<class F>
+   decltype(auto) with_write(F&& fn)
+   {
+      write_lock lock{ block_->mutex };
+      return std::forward<F>(fn)(block_->value);
+   }
+
+   read_proxy read() const { return read_proxy{ block_.get() }; }
+
+   write_proxy write() { return write_proxy{ block_.get() }; }
+
+   long use_count() const noexcept { return block_.data_.get().use_count(); }
+
+   // assignment writes through (like a reference), holding a write lock
+   synchronized_sref& operator=(const synchronized_sref& other)
+   {
+      // moved-from: shares the other block (no lock involved)
+      if (details::sref_access::moved_from(block_)) {
+         block_.data_ = other.block_.data_;
+         return *this;
+      }
+
+      // self-reference (or another reference to the same object)
+      if (&block_.get() == &other.block_.get())
+         return *this;
+
+      // copy first, so both locks are never held together (no deadlocks)
+      T copy = other.with_read([](const T& value) { return value; });
+      with_write([&copy](T& value) { value = std::move(copy); });
+
+      return *this;
+   }
+
+   // moved-from: takes the block of 'corpse' (otherwise writes through,
+   // moving the value only if 'corpse' is its last reference)
+   synchronized_sref& operator=(synchronized_sref&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (details::sref_access::moved_from(block_)) {
+         block_.data_ = std::move(corpse.block_.data_);
+         return *this;
+      }
+
+      if (corpse.use_count() > 1)
+         return *this = static_cast<const synchronized_sref&>(corpse);
+
+      T value = corpse.with_write([](T& v) { return std::move(v); });
+      with_write([&value](T& v) { v = std::move(value); });
+
+      return *this;
+   }
+
+   synchronized_sref& operator=(const T& value)
+   {
+      with_write([&value](T& v) { v = value; });
+      return *this;
+   }
+
+   synchronized_sref& operator=(T&& value)
+   {
+      with_write([&value](T& v) { v = std::move(value); });
+      return *this;
+   }
+
+private:
+   sref<block_type> block_;
+};
+
+// creates a new 'synchronized_sref' (lock, object and control block in a
+// single allocation)
+template<class T, class Mutex = details::default_shared_mutex, class... Args>
+synchronized_sref<T, Mutex>
+make_synchronized_sref(Args&&... args)
+{
+   return synchronized_sref<T, Mutex>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_SYNCHRONIZED_SREF_HPP
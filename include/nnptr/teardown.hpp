@@ -0,0 +1,169 @@
+#ifndef NNPTR_TEARDOWN_HPP
+#define NNPTR_TEARDOWN_HPP
+// ====================================================
+// Iterative Teardown of Not Null Shared References (nnptr::teardown)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref
+
+// ========================================================================
+// Deep chains and trees built from sref members are destroyed recursively
+// (each destructor drops the next sref), which may overflow the stack and
+// cause long pauses. A teardown object replaces this recursion with an
+// explicit worklist, optionally processed in slices (node or time budget).
+//
+// Types opt in with an ADL hook that moves their sref children out:
+//
+//   template<class Sink>
+//   void nnptr_detach(Node& node, Sink& sink) { sink(std::move(node.next)); }
+//
+// When a reference taken by teardown is the last one, children are
+// detached into the worklist before the object is destroyed (so its
+// destructor only sees moved-from children). Objects still shared with
+// other references are just released, and types without hook are simply
+// destroyed (normal recursion).
+//
+// Objects under teardown must not be observed by sweak from other threads:
+// a concurrent lock() between the use_count() check and the detach would
+// see children disappear (std::shared_ptr gives no weak count to check).
+// ========================================================================
+
+#include <chrono>      // steady_clock
+#include <cstddef>     // size_t
+#include <deque>       // deque
+#include <limits>      // numeric_limits
+#include <new>         // placement new
+#include <type_traits> // aligned_storage, true_type, false_type
+#include <utility>     // declval, move
+
+namespace nnptr {
+
+class teardown;
+
+namespace details {
+
+template<class T, class = void>
+struct has_detach : std::false_type
+{};
+
+template<class T>
+struct has_detach<T, decltype(nnptr_detach(std::declval<T&>(), std::declval<teardown&>()))> : std::true_type
+{};
+
+} // namespace details
+
+class teardown
+{
+public:
+   using clock = std::chrono::steady_clock;
+
+   static constexpr std::size_t no_node_budget = std::numeric_limits<std::size_t>::max();
+
+   // each step() destroys up to 'node_budget' objects and stops after
+   // 'time_budget' (checked every few objects)
+   explicit teardown(std::size_t node_budget = no_node_budget,
+                     clock::duration time_budget = clock::duration::max())
+     : node_budget_{ node_budget }
+     , time_budget_{ time_budget }
+   {}
+
+   teardown(const teardown&) = delete;
+   teardown& operator=(const teardown&) = delete;
+
+   // whatever is left is destroyed here
+   ~teardown() { run(); }
+
+   // takes 'ref' into the worklist (also used by nnptr_detach hooks)
+   template<class T>
+   void operator()(sref<T>&& ref)
+   {
+      static_assert(sizeof(sref<T>) == sizeof(storage_type) && alignof(sref<T>) <= alignof(storage_type),
+                    "unexpected sref layout");
+      work_.emplace_back();
+      item& it = work_.back();
+      new (&it.storage) sref<T>(std::move(ref));
+      it.release = &release_item<T>;
+   }
+
+   // processes one slice of work (returns true if some work remains)
+   bool step()
+   {
+      clock::time_point deadline = time_budget_ == clock::duration::max()
+                                     ? clock::time_point::max()
+                                     : clock::now() + time_budget_;
+      for (std::size_t n = 0; n < node_budget_ && !work_.empty(); n++) {
+         if ((n % 64) == 63 && clock::now() >= deadline)
+            break;
+         release_back();
+      }
+      return !work_.empty();
+   }
+
+   // processes all work (ignores budgets)
+   void run()
+   {
+      while (!work_.empty())
+         release_back();
+   }
+
+   bool empty() const noexcept { return work_.empty(); }
+
+   std::size_t pending() const noexcept { return work_.size(); }
+
+private:
+   // all sref<T> share the layout of a std::shared_ptr
+   using storage_type = std::aligned_storage<sizeof(sref<int>), alignof(sref<int>)>::type;
+
+   struct item
+   {
+      storage_type storage;
+      void (*release)(teardown&);
+   };
+
+   // handles are never moved around while waiting (deque keeps elements in place)
+   std::deque<item> work_;
+   std::size_t node_budget_;
+   clock::duration time_budget_;
+
+   void release_back() { work_.back().release(*this); }
+
+   template<class T>
+   static void release_item(teardown& t)
+   {
+      sref<T>* p = reinterpret_cast<sref<T>*>(&t.work_.back().storage);
+      sref<T> ref{ std::move(*p) };
+      p->~sref<T>();
+      t.work_.pop_back();
+      detach(ref, t, details::has_detach<T>{});
+   }
+
+   template<class T>
+   static void detach(sref<T>& ref, teardown& t, std::true_type)
+   {
+      // last reference: object dies at the end of this scope (assumes no
+      // concurrent sweak::lock, see above)
+      if (ref.data_.get().use_count() == 1)
+         nnptr_detach(ref.get(), t);
+   }
+
+   template<class T>
+   static void detach(sref<T>&, teardown&, std::false_type)
+   {}
+};
+
+// drops 'ref' without recursion (children are destroyed one at a time)
+template<class T>
+void
+destroy(sref<T>&& ref)
+{
+   teardown t;
+   t(std::move(ref));
+   t.run();
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_TEARDOWN_HPP
@@ -0,0 +1,212 @@
+#ifndef NNPTR_THIN_SREF_HPP
+#define NNPTR_THIN_SREF_HPP
+// ====================================================
+// Thin Not Null Shared Reference (nnptr::thin_sref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, in_place
+
+// ========================================================================
+// thin_sref<T> behaves as sref<T>, but handle is a single pointer into a
+// block that holds reference counter just in front of the object (any
+// type T, no changes required on T). For this reason, it can only be
+// built by value or in place (see make_thin_sref), never from T*.
+//
+// Since object lives inside the block, thin_sref<T> cannot become a
+// thin_sref<Base>. Use to_sref<Base>() for that (sharing ownership).
+// ========================================================================
+
+#include <atomic>      // atomic
+#include <exception>   // terminate
+#include <memory>      // shared_ptr
+#include <type_traits> // enable_if, is_convertible
+#include <utility>     // forward, move
+
+namespace nnptr {
+
+namespace details {
+
+template<class T>
+struct thin_block
+{
+   std::atomic<long> count{ 1 };
+   T value;
+
+   template<class... Args>
+   explicit thin_block(Args&&... args)
+     : value(std::forward<Args>(args)...)
+   {}
+};
+
+} // namespace details
+
+template<typename T>
+class thin_sref
+{
+   using block_type = details::thin_block<T>;
+
+public:
+   // this constructor can be used to "move" into new thin_sref versions
+   // this requires a move constructor over the type T
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   thin_sref(X&& other)
+     : block_{ new block_type(std::move(other)) }
+   {}
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   thin_sref(const X& other)
+     : block_{ new block_type(other) }
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit thin_sref(in_place_t, Args&&... args)
+     : block_{ new block_type(std::forward<Args>(args)...) }
+   {}
+
+   // disallow explicit nullptr
+   thin_sref(std::nullptr_t data) = delete;
+
+   thin_sref(const thin_sref& other) noexcept
+     : block_{ other.get_block() }
+   {
+      block_->count.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // takes ownership from 'corpse' (no reference counting involved)
+   // moved-from thin_sref has no block: it can only be destroyed, or be
+   // assigned to (then it shares or takes the other block, like sref)
+   thin_sref(thin_sref&& corpse) noexcept
+     : block_{ corpse.block_ }
+   {
+      corpse.block_ = nullptr;
+   }
+
+   ~thin_sref()
+   {
+      if (block_ && block_->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         delete block_;
+   }
+
+   T* operator->() { return &get_block()->value; }
+
+   const T* operator->() const { return &get_block()->value; }
+
+   T& operator*() { return get_block()->value; }
+
+   const T& operator*() const { return get_block()->value; }
+
+   T& get() { return get_block()->value; }
+
+   const T& get() const { return get_block()->value; }
+
+   operator T&() { return get_block()->value; }
+
+   long use_count() const noexcept
+   {
+      return get_block()->count.load(std::memory_order_relaxed);
+   }
+
+   // shares ownership with a new sref<Y> (allocates a std::shared_ptr control block)
+   template<class Y = T, typename = typename std::enable_if<std::is_convertible<T*, Y*>::value>::type>
+   sref<Y> to_sref() const
+   {
+      thin_sref keep{ *this };
+      Y* ptr = &keep.block_->value;
+      return std::shared_ptr<Y>(ptr, [keep](Y*) {});
+   }
+
+   thin_sref& operator=(const thin_sref& other)
+   {
+      // self-reference
+      if (this == &other)
+         return *this;
+
+      // moved-from: shares the other block
+      if (!block_) {
+         block_ = other.get_block();
+         block_->count.fetch_add(1, std::memory_order_relaxed);
+         return *this;
+      }
+
+      // ASSUME NON-NULL FOR operator=
+      get_block()->value = other.get_block()->value;
+
+      return *this;
+   }
+
+   // moved-from: takes the block of 'corpse' (otherwise writes through,
+   // moving the value only if 'corpse' is its last reference)
+   thin_sref& operator=(thin_sref&& corpse)
+   {
+      if (this == &corpse)
+         return *this;
+
+      if (!block_) {
+         block_ = corpse.block_;
+         corpse.block_ = nullptr;
+         return *this;
+      }
+
+      // value is only moved when no other thin_sref can see it
+      if (corpse.use_count() > 1)
+         get_block()->value = corpse.get_block()->value;
+      else
+         get_block()->value = std::move(corpse.get_block()->value);
+
+      return *this;
+   }
+
+   // assignment writes through (like a reference), so no new thin_sref is created
+   thin_sref& operator=(const T& value)
+   {
+      get_block()->value = value;
+      return *this;
+   }
+
+   thin_sref& operator=(T&& value)
+   {
+      get_block()->value = std::move(value);
+      return *this;
+   }
+
+private:
+   block_type* block_;
+
+   block_type* get_block() const noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (block_ == nullptr)
+         std::terminate();
+#endif
+      return block_;
+   }
+};
+
+// creates a new 'thin_sref' (counter and object in a single allocation)
+template<class T, class... Args>
+thin_sref<T>
+make_thin_sref(Args&&... args)
+{
+   return thin_sref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_THIN_SREF_HPP
@@ -0,0 +1,267 @@
+#ifndef NNPTR_UREF_HPP
+#define NNPTR_UREF_HPP
+// ====================================================
+// Not Null Unique Reference (nnptr::uref)
+// github.com/igormcoelho/nnptr
+// MIT License (2021)
+// ====================================================
+
+// This library depends on...
+#include "sref.hpp" // sref, sref_view, in_place
+
+// ========================================================================
+// uref<T> is the single owner of an object (move-only, never null), for
+// objects that have exactly one owner until they are published. There is
+// no reference counting at all, and the handle is a single pointer.
+//
+// Object lives in a chunk that also reserves room for a std::shared_ptr
+// control block, so share() turns a uref<T> into an sref<T> without
+// copying the object and without a new allocation (control block is
+// built in place, through a custom allocator).
+//
+// A moved-from uref can only be destroyed or be move assigned to (checked
+// during Debug).
+// ========================================================================
+
+#include <cstddef>     // size_t, max_align_t
+#include <exception>   // terminate
+#include <memory>      // shared_ptr
+#include <new>         // operator new, placement new
+#include <type_traits> // aligned_storage, enable_if, is_same
+#include <utility>     // forward, move
+
+namespace nnptr {
+
+namespace details {
+
+// room for a std::shared_ptr control block (with empty deleter/allocator)
+constexpr std::size_t uref_control_size = 64;
+
+template<class T>
+struct uref_chunk
+{
+   // control block area comes first, so its address is the chunk address
+   typename std::aligned_storage<uref_control_size, alignof(std::max_align_t)>::type control;
+   T value;
+
+   template<class... Args>
+   explicit uref_chunk(in_place_t, Args&&... args)
+     : value(std::forward<Args>(args)...)
+   {}
+};
+
+// object dies with last sref (chunk memory is released with control block)
+template<class T>
+struct uref_destroy
+{
+   void operator()(T* p) const noexcept { p->~T(); }
+};
+
+// gives the chunk itself for the control block
+template<class U>
+struct uref_allocator
+{
+   using value_type = U;
+
+   void* chunk;
+
+   explicit uref_allocator(void* _chunk) noexcept
+     : chunk{ _chunk }
+   {}
+
+   template<class V>
+   uref_allocator(const uref_allocator<V>& other) noexcept
+     : chunk{ other.chunk }
+   {}
+
+   // a separate block could not release the chunk (it would leak), so a
+   // standard library with a larger control block fails to compile
+   U* allocate(std::size_t n)
+   {
+      static_assert(sizeof(U) <= uref_control_size && alignof(U) <= alignof(std::max_align_t),
+                    "std::shared_ptr control block does not fit in uref chunk");
+#ifndef NO_NNPTR_CHECKS
+      if (n != 1)
+         std::terminate();
+#endif
+      (void)n;
+      return static_cast<U*>(chunk);
+   }
+
+   // releases the whole chunk (control block is at its start)
+   void deallocate(U* p, std::size_t) noexcept { ::operator delete(p); }
+
+   template<class V>
+   bool operator==(const uref_allocator<V>& other) const noexcept
+   {
+      return chunk == other.chunk;
+   }
+
+   template<class V>
+   bool operator!=(const uref_allocator<V>& other) const noexcept
+   {
+      return chunk != other.chunk;
+   }
+};
+
+} // namespace details
+
+template<typename T>
+class uref
+{
+   static_assert(alignof(T) <= alignof(std::max_align_t), "uref does not support over-aligned types");
+
+   using chunk_type = details::uref_chunk<T>;
+
+public:
+   // this constructor can be used to "move" into new uref versions
+   // this requires a move constructor over the type T
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_move_constructible<X>::value>::type>
+   uref(X&& other)
+     : chunk_{ new_chunk(std::move(other)) }
+   {}
+
+   // this is for existing references (must have copy constructor)
+   template<
+     class X,
+     typename =
+       typename std::enable_if<std::is_same<X, T>::value>::type,
+     typename =
+       typename std::enable_if<std::is_copy_constructible<X>::value>::type>
+   uref(const X& other)
+     : chunk_{ new_chunk(other) }
+   {}
+
+   template<
+     class... Args,
+     typename =
+       typename std::enable_if<std::is_constructible<T, Args...>::value>::type>
+   explicit uref(in_place_t, Args&&... args)
+     : chunk_{ new_chunk(std::forward<Args>(args)...) }
+   {}
+
+   // disallow explicit nullptr
+   uref(std::nullptr_t data) = delete;
+
+   uref(const uref&) = delete;
+
+   // takes ownership from 'corpse'
+   uref(uref&& corpse) noexcept
+     : chunk_{ corpse.chunk_ }
+   {
+      corpse.chunk_ = nullptr;
+   }
+
+   ~uref() { free_chunk(); }
+
+   T* operator->() { return &get_chunk()->value; }
+
+   const T* operator->() const { return &get_chunk()->value; }
+
+   T& operator*() { return get_chunk()->value; }
+
+   const T& operator*() const { return get_chunk()->value; }
+
+   T& get() { return get_chunk()->value; }
+
+   const T& get() const { return get_chunk()->value; }
+
+   operator T&() { return get_chunk()->value; }
+
+   // non-owning view, for hot function parameters (see sref_view)
+   sref_view<T> borrow() { return sref_view<T>{ get_chunk()->value }; }
+
+   sref_view<const T> borrow() const { return sref_view<const T>{ get_chunk()->value }; }
+
+   operator sref_view<T>() { return borrow(); }
+
+   operator sref_view<const T>() const { return borrow(); }
+
+   // publishes object as an sref<T> (no copy, no new allocation)
+   sref<T> share() &&
+   {
+      chunk_type* c = get_chunk();
+      chunk_ = nullptr;
+      return sref<T>{ std::shared_ptr<T>(&c->value,
+                                         details::uref_destroy<T>{},
+                                         details::uref_allocator<T>{ static_cast<void*>(c) }) };
+   }
+
+   uref& operator=(const uref&) = delete;
+
+   // frees current object and takes ownership from 'corpse'
+   uref& operator=(uref&& corpse) noexcept
+   {
+      if (this != &corpse) {
+         free_chunk();
+         chunk_ = corpse.chunk_;
+         corpse.chunk_ = nullptr;
+      }
+      return *this;
+   }
+
+   // assignment writes through (like a reference)
+   uref& operator=(const T& value)
+   {
+      get_chunk()->value = value;
+      return *this;
+   }
+
+   uref& operator=(T&& value)
+   {
+      get_chunk()->value = std::move(value);
+      return *this;
+   }
+
+private:
+   chunk_type* chunk_;
+
+   template<class... Args>
+   static chunk_type* new_chunk(Args&&... args)
+   {
+      // releases memory if T constructor throws (without try/catch)
+      struct memory_guard
+      {
+         void* memory;
+         ~memory_guard() { ::operator delete(memory); }
+      } guard{ ::operator new(sizeof(chunk_type)) };
+      chunk_type* c = new (guard.memory) chunk_type(in_place, std::forward<Args>(args)...);
+      guard.memory = nullptr;
+      return c;
+   }
+
+   void free_chunk() noexcept
+   {
+      if (chunk_) {
+         chunk_->~chunk_type();
+         ::operator delete(chunk_);
+      }
+   }
+
+   chunk_type* get_chunk() const noexcept
+   {
+#ifndef NO_NNPTR_CHECKS
+      if (chunk_ == nullptr)
+         std::terminate();
+#endif
+      return chunk_;
+   }
+};
+
+// creates a new 'uref' (object and room for a future control block in a
+// single allocation)
+template<class T, class... Args>
+uref<T>
+make_uref(Args&&... args)
+{
+   return uref<T>{ in_place, std::forward<Args>(args)... };
+}
+
+} // namespace nnptr
+
+#endif // NNPTR_UREF_HPP